@@ -0,0 +1,127 @@
+# Sources of the application without main(), shared with the benchmarks in
+# tests/bench. The wallet is selected by the CONFIG switches set before this
+# file is included.
+
+QT += core gui widgets concurrent
+
+CONFIG += c++14
+
+SOURCES += \
+    $$PWD/src/AES256.cc \
+    $$PWD/src/BreachChecker.cc \
+    $$PWD/src/CipherStream.cc \
+    $$PWD/src/helper.cc \
+    $$PWD/src/MainFrame.cc \
+    $$PWD/src/PasswordGenerator.cc \
+    $$PWD/src/PasswordListItem.cc \
+    $$PWD/src/PasswordStrength.cc \
+    $$PWD/src/StatusBubble.cc \
+    $$PWD/src/WalletDelegate.cc
+
+HEADERS += \
+    $$PWD/src/AES256.h \
+    $$PWD/src/BreachChecker.h \
+    $$PWD/src/CipherStream.h \
+    $$PWD/src/helper.h \
+    $$PWD/src/main.h \
+    $$PWD/src/MainFrame.h \
+    $$PWD/src/PasswordGenerator.h \
+    $$PWD/src/PasswordListItem.h \
+    $$PWD/src/PasswordStrength.h \
+    $$PWD/src/StatusBubble.h \
+    $$PWD/src/WalletDelegate.h
+
+RESOURCES += \
+    $$PWD/src/main.qrc
+
+FORMS += \
+    $$PWD/src/MainFrame.ui
+
+CONFIG(use_kwallet)|CONFIG(use_localwallet)|CONFIG(use_fakewallet) {
+    SOURCES += \
+        $$PWD/src/kde/AuditDialog.cc \
+        $$PWD/src/kde/BreachAudit.cc \
+        $$PWD/src/kde/CredentialModel.cc \
+        $$PWD/src/kde/EntrySnapshot.cc \
+        $$PWD/src/kde/EntryUsage.cc \
+        $$PWD/src/kde/PasswordReuseAudit.cc \
+        $$PWD/src/kde/PasswordStrengthAudit.cc \
+        $$PWD/src/kde/SipHash.cc \
+        $$PWD/src/kde/StateFile.cc \
+        $$PWD/src/kde/TrigramIndex.cc \
+        $$PWD/src/kde/WalletArchive.cc \
+        $$PWD/src/kde/WalletAudit.cc \
+        $$PWD/src/kde/WalletContent.cc \
+        $$PWD/src/kde/WalletExporter.cc \
+        $$PWD/src/kde/WalletFilterModel.cc \
+        $$PWD/src/kde/WalletImporter.cc \
+        $$PWD/src/kde/WalletModel.cc \
+        $$PWD/src/kde/WalletWidget.cc \
+        $$PWD/src/kde/WalletWorker.cc
+
+    HEADERS += \
+        $$PWD/src/kde/AuditDialog.h \
+        $$PWD/src/kde/BreachAudit.h \
+        $$PWD/src/kde/CredentialModel.h \
+        $$PWD/src/kde/EntrySnapshot.h \
+        $$PWD/src/kde/EntryUsage.h \
+        $$PWD/src/kde/PasswordReuseAudit.h \
+        $$PWD/src/kde/PasswordStrengthAudit.h \
+        $$PWD/src/kde/SipHash.h \
+        $$PWD/src/kde/StateFile.h \
+        $$PWD/src/kde/TrigramIndex.h \
+        $$PWD/src/kde/WalletArchive.h \
+        $$PWD/src/kde/WalletAudit.h \
+        $$PWD/src/kde/WalletBackend.h \
+        $$PWD/src/kde/WalletContent.h \
+        $$PWD/src/kde/WalletExporter.h \
+        $$PWD/src/kde/WalletFilterModel.h \
+        $$PWD/src/kde/WalletImporter.h \
+        $$PWD/src/kde/WalletModel.h \
+        $$PWD/src/kde/WalletWidget.h \
+        $$PWD/src/kde/WalletWorker.h
+
+    #RESOURCES += $$PWD/src/kde/*.qrc
+
+    FORMS += \
+        $$PWD/src/kde/WalletWidget.ui
+
+    CONFIG(use_localwallet) {
+        SOURCES += \
+            $$PWD/src/local/LocalWallet.cc
+
+        HEADERS += \
+            $$PWD/src/local/LocalWallet.h
+    } else {
+        SOURCES += \
+            $$PWD/src/kde/KWalletBackend.cc
+
+        HEADERS += \
+            $$PWD/src/kde/KWalletBackend.h
+
+        CONFIG(use_fakewallet) {
+            INCLUDEPATH += $$PWD/src/fake
+
+            SOURCES += \
+                $$PWD/src/fake/kwallet.cc
+
+            HEADERS += \
+                $$PWD/src/fake/kwallet.h
+        } else {
+            QT += KWallet
+        }
+    }
+} else {
+    SOURCES += \
+        $$PWD/src/dummy/NoWallet.cc
+}
+
+linux-g++ {
+    QMAKE_CXXFLAGS += -Wno-unused-variable -Wno-unused-parameter
+
+    CONFIG(debug, debug|release) {
+        QMAKE_CXXFLAGS -= -g
+        QMAKE_CXXFLAGS += -g3 -gdwarf-2
+    }
+}
+
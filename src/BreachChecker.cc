@@ -0,0 +1,234 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "BreachChecker.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QtEndian>
+#include <QDebug>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+const QByteArray PREFILTER_MAGIC("PMBF");
+const quint8 PREFILTER_VERSION = 1;
+
+// magic, version, hash count, two reserved bytes, bit count and corpus size
+const int PREFILTER_HEADER_SIZE = 4 + 1 + 1 + 2 + 8 + 8;
+
+// probes guessed by interpolation before falling back to bisection, which
+// bounds the lookups in corpora that are not uniformly distributed
+const int MAX_INTERPOLATION_STEPS = 8;
+
+inline quint64 prefix(const uchar* hash)
+{
+    return qFromBigEndian<quint64>(hash);
+}
+
+// double hashing, the SHA-1 itself provides the independent hashes
+inline quint64 bloomBit(const uchar* hash, int i, quint64 bitCount)
+{
+    const quint64 h1 = qFromBigEndian<quint64>(hash);
+    const quint64 h2 = qFromBigEndian<quint64>(hash + 8) | 1;
+    return (h1 + quint64(i) * h2) % bitCount;
+}
+
+}
+
+BreachChecker::BreachChecker() :
+    records_(nullptr),
+    count_(0),
+    bits_(nullptr),
+    bitCount_(0),
+    hashCount_(0)
+{
+}
+
+BreachChecker::~BreachChecker()
+{
+}
+
+QString BreachChecker::corpusFile()
+{
+    QSettings s;
+    QString fileName = s.value("breach/corpus").toString();
+    if (fileName.isEmpty())
+    {
+        QDir dataDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+        fileName = dataDir.absolutePath() + QDir::separator() + "breached.sha1";
+    }
+    return fileName;
+}
+
+bool BreachChecker::open(const QString& fileName)
+{
+    corpus_.setFileName(fileName);
+    if (!corpus_.open(QIODevice::ReadOnly))
+        return false;
+
+    const qint64 size = corpus_.size();
+    if (size == 0 || size % HASH_LENGTH != 0)
+    {
+        qWarning() << "Breach corpus has an invalid size" << fileName;
+        corpus_.close();
+        return false;
+    }
+
+    records_ = corpus_.map(0, size);
+    if (!records_)
+    {
+        corpus_.close();
+        return false;
+    }
+
+    count_ = size / HASH_LENGTH;
+    openPrefilter(fileName + ".bloom");
+    return true;
+}
+
+bool BreachChecker::contains(const QString& password) const
+{
+    const QByteArray hash = QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha1);
+    return containsHash(reinterpret_cast<const uchar*>(hash.constData()));
+}
+
+bool BreachChecker::containsHash(const uchar* hash) const
+{
+    if (!records_ || !mayContain(hash))
+        return false;
+
+    const quint64 key = prefix(hash);
+    qint64 lo = 0;
+    qint64 hi = count_ - 1;
+
+    for (int step = 0; lo <= hi; ++step)
+    {
+        const quint64 loKey = prefix(records_ + lo * HASH_LENGTH);
+        const quint64 hiKey = prefix(records_ + hi * HASH_LENGTH);
+        if (key < loKey || key > hiKey)
+            return false;
+
+        qint64 pos = lo + (hi - lo) / 2;
+        if (step < MAX_INTERPOLATION_STEPS && hiKey != loKey)
+            pos = lo + qint64(double(key - loKey) / double(hiKey - loKey) * double(hi - lo));
+        pos = qBound(lo, pos, hi);
+
+        int cmp = std::memcmp(records_ + pos * HASH_LENGTH, hash, HASH_LENGTH);
+        if (cmp == 0)
+            return true;
+
+        if (cmp < 0)
+            lo = pos + 1;
+        else
+            hi = pos - 1;
+    }
+    return false;
+}
+
+void BreachChecker::openPrefilter(const QString& fileName)
+{
+    prefilter_.setFileName(fileName);
+    if (!prefilter_.exists() || !prefilter_.open(QIODevice::ReadOnly))
+        return;
+
+    const uchar* data = prefilter_.map(0, prefilter_.size());
+    if (!data || prefilter_.size() < PREFILTER_HEADER_SIZE
+            || std::memcmp(data, PREFILTER_MAGIC.constData(), 4) != 0 || data[4] != PREFILTER_VERSION)
+    {
+        prefilter_.close();
+        return;
+    }
+
+    const int hashCount = data[5];
+    const quint64 bitCount = qFromBigEndian<quint64>(data + 8);
+    const qint64 corpusCount = qFromBigEndian<qint64>(data + 16);
+
+    // built for another corpus, it would reject breached passwords
+    if (hashCount == 0 || bitCount == 0 || corpusCount != count_
+            || quint64(prefilter_.size() - PREFILTER_HEADER_SIZE) < (bitCount + 7) / 8)
+    {
+        qWarning() << "Ignoring breach prefilter not matching the corpus" << fileName;
+        prefilter_.close();
+        return;
+    }
+
+    bits_ = data + PREFILTER_HEADER_SIZE;
+    bitCount_ = bitCount;
+    hashCount_ = hashCount;
+}
+
+bool BreachChecker::mayContain(const uchar* hash) const
+{
+    if (!bits_)
+        return true;
+
+    for (int i = 0; i < hashCount_; ++i)
+    {
+        const quint64 bit = bloomBit(hash, i, bitCount_);
+        if (!(bits_[bit / 8] & (1 << (bit % 8))))
+            return false;
+    }
+    return true;
+}
+
+bool BreachChecker::writePrefilter(const QString& corpusFile, int bitsPerHash)
+{
+    BreachChecker checker;
+    if (!checker.open(corpusFile))
+        return false;
+
+    // an older filter is replaced, it must not be mapped while truncated
+    checker.prefilter_.close();
+    checker.bits_ = nullptr;
+
+    const quint64 bitCount = qMax<quint64>(64, quint64(checker.count_) * bitsPerHash);
+    // optimal for the false positive rate of the filter size
+    const int hashCount = qBound(1, int(std::lround(bitsPerHash * std::log(2.0))), 255);
+
+    // the bits are set in the mapped file, the filter may be larger than the memory
+    QFile file(corpusFile + ".bloom");
+    if (!file.open(QIODevice::ReadWrite | QIODevice::Truncate)
+            || !file.resize(PREFILTER_HEADER_SIZE + qint64((bitCount + 7) / 8)))
+        return false;
+
+    uchar* data = file.map(0, file.size());
+    if (!data)
+        return false;
+
+    std::memcpy(data, PREFILTER_MAGIC.constData(), 4);
+    data[4] = PREFILTER_VERSION;
+    data[5] = uchar(hashCount);
+    qToBigEndian<quint64>(bitCount, data + 8);
+    qToBigEndian<qint64>(checker.count_, data + 16);
+
+    uchar* bits = data + PREFILTER_HEADER_SIZE;
+    for (qint64 i = 0; i < checker.count_; ++i)
+    {
+        const uchar* hash = checker.records_ + i * HASH_LENGTH;
+        for (int k = 0; k < hashCount; ++k)
+        {
+            const quint64 bit = bloomBit(hash, k, bitCount);
+            bits[bit / 8] |= uchar(1 << (bit % 8));
+        }
+    }
+
+    return file.unmap(data) && file.flush();
+}
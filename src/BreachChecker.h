@@ -0,0 +1,69 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BREACHCHECKER_H
+#define BREACHCHECKER_H
+
+#include <QFile>
+#include <QString>
+
+// Looks up passwords in a local corpus of breached passwords, nothing is
+// sent over the network.
+//
+// The corpus is a file of sorted binary SHA-1 hashes of 20 bytes each, like
+// the "ordered by hash" download of Have I Been Pwned without the counts:
+//     cut -d: -f1 pwned-passwords-sha1-ordered-by-hash.txt | xxd -r -p > breached.sha1
+// It is mapped into memory and searched by interpolation. The hashes are
+// uniformly distributed, so a lookup touches two or three pages of it.
+//
+// An optional Bloom filter next to the corpus (same name plus ".bloom")
+// rejects most unknown passwords without touching the corpus at all. It is
+// built by running the application with --build-breach-prefilter.
+class BreachChecker
+{
+public:
+    static constexpr int HASH_LENGTH = 20;
+
+    BreachChecker();
+    ~BreachChecker();
+
+    // the corpus configured in the settings or breached.sha1 in the data directory
+    static QString corpusFile();
+    static bool writePrefilter(const QString& corpusFile, int bitsPerHash = 10);
+
+    bool open(const QString& fileName);
+    bool isOpen() const { return records_ != nullptr; }
+
+    // the lookups do not modify the checker and may run on several threads
+    bool contains(const QString& password) const;
+    bool containsHash(const uchar* hash) const;
+
+private:
+    QFile corpus_;
+    const uchar* records_;
+    qint64 count_;
+
+    QFile prefilter_;
+    const uchar* bits_;
+    quint64 bitCount_;
+    int hashCount_;
+
+    void openPrefilter(const QString& fileName);
+    bool mayContain(const uchar* hash) const;
+};
+
+#endif // BREACHCHECKER_H
@@ -0,0 +1,144 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CipherStream.h"
+
+#include <QCryptographicHash>
+#include <QMessageAuthenticationCode>
+#include <QtEndian>
+#include <random>
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+#include <QPasswordDigestor>
+#endif
+
+namespace {
+
+// iterations of PBKDF2, makes guessing passphrases expensive
+const int KDF_ITERATIONS = 210000;
+
+QByteArray pbkdf2(const QByteArray& password, const QByteArray& salt, int iterations, int length)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+    return QPasswordDigestor::deriveKeyPbkdf2(QCryptographicHash::Sha512, password, salt, iterations, length);
+#else
+    // RFC 8018, section 5.2
+    QMessageAuthenticationCode hmac(QCryptographicHash::Sha512, password);
+    QByteArray key;
+
+    for (quint32 block = 1; key.size() < length; ++block)
+    {
+        QByteArray index(sizeof(quint32), 0);
+        qToBigEndian<quint32>(block, index.data());
+
+        hmac.reset();
+        hmac.addData(salt);
+        hmac.addData(index);
+        QByteArray u = hmac.result();
+        QByteArray t = u;
+
+        for (int i = 1; i < iterations; ++i)
+        {
+            hmac.reset();
+            hmac.addData(u);
+            u = hmac.result();
+            for (int j = 0; j < t.size(); ++j)
+                t[j] = t[j] ^ u[j];
+        }
+        key += t;
+    }
+    return key.left(length);
+#endif
+}
+
+}
+
+CipherStream::CipherStream(const QByteArray& key, const QByteArray& nonce) :
+    nonce_(nonce),
+    counter_(0),
+    keyStreamPos_(0)
+{
+    Q_ASSERT(nonce.size() == NONCE_LENGTH);
+
+    cipher_.setKey(key);
+}
+
+QByteArray CipherStream::process(const QByteArray& data)
+{
+    QByteArray output(data);
+
+    if (keyStream_.size() - keyStreamPos_ < data.size())
+        generateKeyStream(data.size());
+
+    const char* ks = keyStream_.constData() + keyStreamPos_;
+    char* out = output.data();
+    for (int i = 0; i < output.size(); ++i)
+        out[i] ^= ks[i];
+
+    keyStreamPos_ += data.size();
+    return output;
+}
+
+void CipherStream::generateKeyStream(int length)
+{
+    // keep the unused rest of the current key stream
+    QByteArray rest = keyStream_.mid(keyStreamPos_);
+
+    int blocks = (length - rest.size() + AES256::BLOCK_LENGTH - 1) / AES256::BLOCK_LENGTH;
+    QByteArray counterBlocks;
+    counterBlocks.reserve(blocks * AES256::BLOCK_LENGTH);
+
+    for (int i = 0; i < blocks; ++i)
+    {
+        uchar counter[sizeof(quint64)];
+        qToBigEndian(counter_++, counter);
+
+        counterBlocks.append(nonce_);
+        counterBlocks.append(reinterpret_cast<const char*>(counter), sizeof(counter));
+    }
+
+    keyStream_ = rest + cipher_.ecbEncrypt(counterBlocks);
+    keyStreamPos_ = 0;
+}
+
+QByteArray CipherStream::randomBytes(int length)
+{
+    std::random_device rnd;
+
+    QByteArray bytes;
+    bytes.reserve(length);
+    while (bytes.size() < length)
+    {
+        quint32 v = rnd();
+        bytes.append(reinterpret_cast<const char*>(&v), qMin<int>(sizeof(v), length - bytes.size()));
+    }
+    return bytes;
+}
+
+void CipherStream::deriveKeys(const QString& passphrase, const QByteArray& salt,
+                              QByteArray& cipherKey, QByteArray& macKey)
+{
+    const QByteArray key = pbkdf2(passphrase.toUtf8(), salt, KDF_ITERATIONS, 2 * AES256::KEY_LENGTH);
+
+    cipherKey = key.left(AES256::KEY_LENGTH);
+    macKey = key.mid(AES256::KEY_LENGTH);
+}
+
+QByteArray CipherStream::mac(const QByteArray& macKey, const QByteArray& data)
+{
+    return QMessageAuthenticationCode::hash(data, macKey, QCryptographicHash::Sha256).left(MAC_LENGTH);
+}
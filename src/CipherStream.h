@@ -0,0 +1,55 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CIPHERSTREAM_H
+#define CIPHERSTREAM_H
+
+#include "AES256.h"
+
+#include <QByteArray>
+#include <QString>
+
+// AES-256 in counter mode. Encryption and decryption are the same operation,
+// the key stream continues over consecutive calls of process().
+class CipherStream
+{
+public:
+    static constexpr int NONCE_LENGTH = 8;
+    static constexpr int SALT_LENGTH = 16;
+    static constexpr int MAC_LENGTH = 16;
+
+    CipherStream(const QByteArray& key, const QByteArray& nonce);
+
+    QByteArray process(const QByteArray& data);
+
+    static QByteArray randomBytes(int length);
+    // PBKDF2 with HMAC-SHA512
+    static void deriveKeys(const QString& passphrase, const QByteArray& salt,
+                           QByteArray& cipherKey, QByteArray& macKey);
+    static QByteArray mac(const QByteArray& macKey, const QByteArray& data);
+
+private:
+    AES256 cipher_;
+    QByteArray nonce_;
+    quint64 counter_;
+    QByteArray keyStream_;
+    int keyStreamPos_;
+
+    void generateKeyStream(int length);
+};
+
+#endif // CIPHERSTREAM_H
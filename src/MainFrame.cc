@@ -16,6 +16,7 @@
  */
 
 #include "MainFrame.h"
+#include "BreachChecker.h"
 #include "PasswordGenerator.h"
 #include "PasswordListItem.h"
 #include "helper.h"
@@ -57,6 +58,14 @@ void setComboBoxItems(QComboBox* cb, QStringList& list) {
     }
 }
 
+template<typename T>
+static bool assign(T& field, const T& value) {
+    if (field == value)
+        return false;
+    field = value;
+    return true;
+}
+
 static QDataStream& operator>>(QDataStream& stream, Qt::CheckState& checkState) {
     int i;
     stream >> i;
@@ -96,6 +105,8 @@ name(name) {
     STREAM_FAILED_RETURN();
     stream >> length;
     STREAM_FAILED_RETURN();
+    failedState = false;
+    updateFingerprint();
 }
 
 MainFrame::OptionSet::OptionSet(const MainFrame::OptionSet& other) :
@@ -110,7 +121,8 @@ MainFrame::OptionSet::OptionSet(const MainFrame::OptionSet& other) :
     specialCharsOn(other.specialCharsOn),
     specialChars(other.specialChars),
     length(other.length),
-    failedState(other.failedState)
+    failedState(other.failedState),
+    fingerprint(other.fingerprint)
 {
 }
 
@@ -131,6 +143,7 @@ MainFrame::OptionSet& MainFrame::OptionSet::operator=(const MainFrame::OptionSet
     specialChars = other.specialChars;
     length = other.length;
     failedState = other.failedState;
+    fingerprint = other.fingerprint;
     return *this;
 }
 
@@ -145,6 +158,7 @@ void MainFrame::OptionSet::readState() {
     specialChars = mainFrame->ui->specialChars->currentText();
     length = mainFrame->ui->passwordLength->value();
     failedState = false;
+    updateFingerprint();
 }
 
 void MainFrame::OptionSet::writeState() {
@@ -162,16 +176,37 @@ void MainFrame::OptionSet::writeState() {
     mainFrame->ui->passwordLength->setValue(length);
 }
 
-bool MainFrame::OptionSet::checkState() {
-    return lowerCaseCharsOn == mainFrame->ui->useLowerCaseChars->checkState()
-        && lowerCaseChars == mainFrame->ui->lowerCaseChars->currentText()
-        && upperCaseCharsOn == mainFrame->ui->useUpperCaseChars->checkState()
-        && upperCaseChars == mainFrame->ui->upperCaseChars->currentText()
-        && numbersOn == mainFrame->ui->useNumbers->checkState()
-        && numbers == mainFrame->ui->numbers->currentText()
-        && specialCharsOn == mainFrame->ui->useSpecialChars->checkState()
-        && specialChars == mainFrame->ui->specialChars->currentText()
-        && length == mainFrame->ui->passwordLength->value();
+bool MainFrame::OptionSet::matches(const OptionSet& other) const {
+    // the strings are only compared when the fingerprints agree
+    return fingerprint == other.fingerprint
+        && length == other.length
+        && lowerCaseCharsOn == other.lowerCaseCharsOn
+        && upperCaseCharsOn == other.upperCaseCharsOn
+        && numbersOn == other.numbersOn
+        && specialCharsOn == other.specialCharsOn
+        && lowerCaseChars == other.lowerCaseChars
+        && upperCaseChars == other.upperCaseChars
+        && numbers == other.numbers
+        && specialChars == other.specialChars;
+}
+
+void MainFrame::OptionSet::updateFingerprint() {
+    uint h = uint(length);
+    h = qHash(lowerCaseChars, h * 31 + lowerCaseCharsOn);
+    h = qHash(upperCaseChars, h * 31 + upperCaseCharsOn);
+    h = qHash(numbers, h * 31 + numbersOn);
+    h = qHash(specialChars, h * 31 + specialCharsOn);
+    fingerprint = h;
+}
+
+Qt::CheckState& MainFrame::OptionSet::charsOn(int charClass) {
+    Qt::CheckState* fields[] = { &lowerCaseCharsOn, &upperCaseCharsOn, &numbersOn, &specialCharsOn };
+    return *fields[charClass];
+}
+
+QString& MainFrame::OptionSet::chars(int charClass) {
+    QString* fields[] = { &lowerCaseChars, &upperCaseChars, &numbers, &specialChars };
+    return *fields[charClass];
 }
 
 QByteArray MainFrame::OptionSet::toByteArray() {
@@ -196,7 +231,9 @@ QByteArray MainFrame::OptionSet::toByteArray() {
 
 MainFrame::MainFrame() :
     ui(new Ui::MainFrame()),
-    generator_(new PasswordGenerator())
+    optionsChanged_(false),
+    generator_(new PasswordGenerator()),
+    breachChecker_(new BreachChecker())
 {
     ui->setupUi(this);
     init();
@@ -209,11 +246,17 @@ MainFrame::~MainFrame()
 
 void MainFrame::init()
 {
+    generator_->initAsync();
+    // without a corpus the breach checks are simply not offered
+    breachChecker_->open(BreachChecker::corpusFile());
+
     FILL_ARRAY(charForms, lowerCaseForm, upperCaseForm, numbersForm, specialsForm);
     FILL_ARRAY(charClassToggles, useLowerCaseChars, useUpperCaseChars, useNumbers, useSpecialChars);
     FILL_ARRAY(charClassMin, lowerCaseMin, upperCaseMin, numbersMin, specialsMin);
     FILL_ARRAY(charClass, lowerCaseChars, upperCaseChars, numbers, specialChars);
 
+    options_ = OptionSet(this, QString());
+
     loadConfig();
 
     handleCharsCheckboxChange(0);
@@ -240,6 +283,10 @@ StatusBubble* MainFrame::getStatusBubble() const {
     return statusBubble;
 }
 
+BreachChecker* MainFrame::getBreachChecker() const {
+    return breachChecker_.data();
+}
+
 void MainFrame::closeEvent(QCloseEvent* event) {
     saveConfig();
     QMainWindow::closeEvent(event);
@@ -271,6 +318,9 @@ void MainFrame::loadConfig() {
         }
     }
 
+    // the handlers kept up with the restored values, read once to be sure
+    options_.readState();
+
     s.beginGroup("presets");
     QStringList presetNames = s.childKeys();
     QString selectedPresetName;
@@ -279,7 +329,7 @@ void MainFrame::loadConfig() {
         OptionSet optionSet(this, presetNames[i], bytes);
         if (!optionSet.failedState) {
             addOptionSet(optionSet);
-            if (selectedPresetName.isNull() && optionSet.checkState()) {
+            if (selectedPresetName.isNull() && optionSet.matches(options_)) {
                 selectedPresetName = presetNames[i];
             }
         } else {
@@ -330,10 +380,20 @@ void MainFrame::handleGeneratePressed() {
     int length = ui->passwordLength->value();
     QString password = generator_->generate(stock, length);
 
+    // short passwords from a small stock may well be in the corpus
+    bool breached = breachChecker_->contains(password);
+    for (int i = 0; breached && i < MAX_BREACH_RETRIES; ++i) {
+        password = generator_->generate(stock, length);
+        breached = breachChecker_->contains(password);
+    }
+
     ui->output->setText(password);
     ui->historyList->insertItem(0, new PasswordListItem(password, length));
 
-    statusBubble->showText(tr("New password with %1 chars generated").arg(length));
+    if (breached)
+        statusBubble->showText(tr("The generated password is known from data breaches"));
+    else
+        statusBubble->showText(tr("New password with %1 chars generated").arg(length));
 }
 
 void MainFrame::handleCopyToClipboardPressed() {
@@ -376,8 +436,13 @@ void MainFrame::handleSavePasswordPressed() {
     {
         if (!entryName->currentText().isEmpty())
         {
+            if (!wallet->savePassword(entryName->currentText(), username->text(), ui->output->text()))
+            {
+                QMessageBox::critical(this, tr("Invalid entry"),
+                    tr("The entry name contains a control character that is not allowed"));
+                return;
+            }
             ui->tabWidget->setCurrentWidget(wallet->getWidget());
-            wallet->savePassword(entryName->currentText(), username->text(), ui->output->text());
             statusBubble->showText(tr("Password saved"));
             emit dialog.accept();
         }
@@ -399,10 +464,13 @@ void MainFrame::handleHistoryDblClick(QListWidgetItem* item) {
 }
 
 void MainFrame::handlePasswordLengthChange(int value) {
-    if (ui->passwordLength->value() < minimumPasswordLength)
+    if (value < minimumPasswordLength) {
         ui->passwordLength->setValue(minimumPasswordLength); // this causes the slot to be called again
-    else
-        ui->pwLengthDisplay->setText(QString::number(value));
+        return;
+    }
+
+    ui->pwLengthDisplay->setText(QString::number(value));
+    optionsChanged_ |= assign(options_.length, value);
 
     shouldResetPresetName();
 }
@@ -415,6 +483,8 @@ void MainFrame::handleCharsCheckboxChange(int)
         if (sndr == 0 || sndr == charClassToggles[i])
         {
             bool checked = charClassToggles[i]->isChecked();
+            optionsChanged_ |= assign(options_.charsOn(i), charClassToggles[i]->checkState());
+
             QObjectList list = charForms[i]->children();
             for (int e = 0; e < list.count(); e++)
             {
@@ -439,6 +509,11 @@ void MainFrame::handleComboboxChange(const QString& newText) {
     }
     combo->insertItem(0, newText);
 
+    for (int i = 0; i < CHAR_CLASSES; ++i) {
+        if (combo == charClass[i])
+            optionsChanged_ |= assign(options_.chars(i), combo->currentText());
+    }
+
     shouldResetPresetName();
 }
 
@@ -498,12 +573,15 @@ void MainFrame::selectPreset(const QString& presetName) {
 }
 
 void MainFrame::shouldResetPresetName() {
-    if (!isSelectingPreset && ui->presetName->currentIndex() >= 0) {
-        QString presetName = ui->presetName->currentText();
-        if (presetList.contains(presetName)) {
-            if (!presetList[presetName].checkState()) {
-                selectPreset(QString());
-            }
-        }
+    // compared once per change, and not before a preset is applied completely
+    if (!optionsChanged_ || isSelectingPreset || ui->presetName->currentIndex() < 0)
+        return;
+
+    optionsChanged_ = false;
+    options_.updateFingerprint();
+
+    QMap<QString, OptionSet>::const_iterator it = presetList.constFind(ui->presetName->currentText());
+    if (it != presetList.constEnd() && !it.value().matches(options_)) {
+        selectPreset(QString());
     }
 }
@@ -22,6 +22,7 @@
 
 #include <QCloseEvent>
 
+class BreachChecker;
 class StatusBubble;
 class WalletDelegate;
 class PasswordGenerator;
@@ -29,12 +30,14 @@ class PasswordGenerator;
 class MainFrame : public QMainWindow {
     Q_OBJECT
     const static int CHAR_CLASSES = 4;
+    const static int MAX_BREACH_RETRIES = 3;
 
 public:
     MainFrame();
     virtual ~MainFrame();
 
     StatusBubble* getStatusBubble() const;
+    BreachChecker* getBreachChecker() const;
 
 protected:
     virtual void closeEvent(QCloseEvent* /*event*/);
@@ -66,7 +69,13 @@ private:
 
         void readState();
         void writeState();
-        bool checkState();
+        // same options as the other set, the names are not compared
+        bool matches(const OptionSet& other) const;
+        void updateFingerprint();
+
+        // the fields of a character class, in the order of the widget arrays
+        Qt::CheckState& charsOn(int charClass);
+        QString& chars(int charClass);
 
         QByteArray toByteArray();
 
@@ -82,6 +91,8 @@ private:
         QString specialChars;
         int length;
         bool failedState;
+        // hash of the options, sets with different ones rarely share it
+        uint fingerprint;
     };
 
     Ui::MainFrame* ui;
@@ -96,9 +107,15 @@ private:
     QMap<QString, OptionSet> presetList;
     bool isSelectingPreset;
 
+    // the options shown by the widgets, updated by their change handlers
+    OptionSet options_;
+    // the options changed since they were last compared to the preset
+    bool optionsChanged_;
+
     int minimumPasswordLength;
 
     QScopedPointer<PasswordGenerator> generator_;
+    QScopedPointer<BreachChecker> breachChecker_;
 
     void init();
     void saveConfig();
@@ -23,6 +23,7 @@
 #include <QCoreApplication>
 #include <QStandardPaths>
 #include <QDir>
+#include <QtConcurrent>
 #include <random>
 
 namespace {
@@ -149,6 +150,15 @@ PasswordGenerator::PasswordGenerator() :
 
 PasswordGenerator::~PasswordGenerator()
 {
+    initFuture_.waitForFinished();
+}
+
+void PasswordGenerator::initAsync()
+{
+    if (initFuture_.isRunning())
+        return;
+
+    initFuture_ = QtConcurrent::run(this, &PasswordGenerator::initCipher);
 }
 
 void PasswordGenerator::initDataStore()
@@ -250,6 +260,8 @@ void PasswordGenerator::saveGeneratorState()
 
 QString PasswordGenerator::generate(const CharacterStock& characterStock, int length)
 {
+    // the state is only touched by the worker until it has finished
+    initFuture_.waitForFinished();
     initCipher();
 
     generateNewBlock();
@@ -23,6 +23,7 @@
 #include <QString>
 #include <QByteArray>
 #include <QList>
+#include <QFuture>
 
 struct CharacterStock
 {
@@ -53,6 +54,9 @@ public:
     PasswordGenerator();
     virtual ~PasswordGenerator();
 
+    // starts the cipher setup on a worker thread, generate() waits for it
+    void initAsync();
+
     QString generate(const CharacterStock& characterStock, int length);
 
 private:
@@ -88,6 +92,7 @@ private:
     Counter counter_;
     DataBlock<AES256::BLOCK_LENGTH> randomBytes_;
     int randomBytePos_;
+    QFuture<void> initFuture_;
 
     void initDataStore();
     void initCipher();
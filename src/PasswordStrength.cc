@@ -0,0 +1,95 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "PasswordStrength.h"
+
+#include <QString>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+
+namespace {
+
+const int LOWER_SIZE = 26;
+const int UPPER_SIZE = 26;
+const int DIGIT_SIZE = 10;
+const int SYMBOL_SIZE = 33;
+// a guess, scripts beyond ASCII are not told apart
+const int OTHER_SIZE = 100;
+
+const char* const KEYBOARD_ROWS[] = {
+    "1234567890",
+    "qwertyuiop",
+    "asdfghjkl",
+    "zxcvbnm",
+};
+
+bool adjacentKeys(QChar a, QChar b)
+{
+    const char ca = a.toLower().toLatin1();
+    const char cb = b.toLower().toLatin1();
+    if (!ca || !cb)
+        return false;
+
+    for (const char* row : KEYBOARD_ROWS)
+    {
+        const char* pa = std::strchr(row, ca);
+        const char* pb = std::strchr(row, cb);
+        if (pa && pb && std::abs(pa - pb) == 1)
+            return true;
+    }
+    return false;
+}
+
+bool followsPattern(QChar prev, QChar c)
+{
+    const int step = int(c.unicode()) - int(prev.unicode());
+    return std::abs(step) <= 1 || adjacentKeys(prev, c);
+}
+
+}
+
+int passwordEntropy(const QString& password)
+{
+    bool lower = false, upper = false, digit = false, symbol = false, other = false;
+    for (QChar c : password)
+    {
+        const ushort u = c.unicode();
+        if (u >= 'a' && u <= 'z')
+            lower = true;
+        else if (u >= 'A' && u <= 'Z')
+            upper = true;
+        else if (u >= '0' && u <= '9')
+            digit = true;
+        else if (u > ' ' && u < 0x7f)
+            symbol = true;
+        else
+            other = true;
+    }
+
+    const int alphabet = (lower ? LOWER_SIZE : 0) + (upper ? UPPER_SIZE : 0) + (digit ? DIGIT_SIZE : 0)
+            + (symbol ? SYMBOL_SIZE : 0) + (other ? OTHER_SIZE : 0);
+    if (alphabet == 0)
+        return 0;
+
+    const double bitsPerChar = std::log2(double(alphabet));
+
+    double bits = 0;
+    for (int i = 0; i < password.size(); ++i)
+        bits += i > 0 && followsPattern(password[i - 1], password[i]) ? 1.0 : bitsPerChar;
+    return int(bits);
+}
@@ -0,0 +1,31 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PASSWORDSTRENGTH_H
+#define PASSWORDSTRENGTH_H
+
+class QString;
+
+// Estimates the entropy of a password in bits.
+//
+// Every character adds the bits of the alphabet the password seems to be
+// drawn from, judged by the character classes it uses. Characters following
+// a pattern, i.e. repeating, counting or walking along a keyboard row, add a
+// single bit only.
+int passwordEntropy(const QString& password);
+
+#endif // PASSWORDSTRENGTH_H
@@ -0,0 +1,250 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "kwallet.h"
+#include "../kde/WalletContent.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QTimer>
+
+namespace {
+
+const char* LATENCY_VARIABLE = "PASSWORDMGR_FAKE_WALLET_LATENCY";
+const char* ENTRIES_VARIABLE = "PASSWORDMGR_FAKE_WALLET_ENTRIES";
+const char* UPDATES_VARIABLE = "PASSWORDMGR_FAKE_WALLET_UPDATES";
+
+// number of entries rewritten by the simulated other application
+const int EXTERNAL_ENTRIES = 16;
+
+typedef QHash<QString, QByteArray> Folder;
+
+struct Storage
+{
+    QMutex mutex;
+    QHash<QString, Folder> folders;
+    QList<KWallet::Wallet*> wallets;
+    // number of entries of new folders, the environment variable if negative
+    int syntheticEntries = -1;
+    int externalWrites = 0;
+};
+
+Q_GLOBAL_STATIC(Storage, storage)
+
+void simulateLatency()
+{
+    static const int latency = qEnvironmentVariableIntValue(LATENCY_VARIABLE);
+    if (latency > 0)
+        QThread::usleep(latency);
+}
+
+QByteArray syntheticContent(int index)
+{
+    WalletContentList content;
+    content.append(WalletContent(QString("user%1").arg(index), QString("password%1").arg(index)));
+    return serializeContent(content);
+}
+
+void populate(Folder& folder, int count)
+{
+    if (count < 0)
+        count = qEnvironmentVariableIntValue(ENTRIES_VARIABLE);
+
+    folder.reserve(count);
+    for (int i = 0; i < count; ++i)
+        folder.insert(QString("entry-%1").arg(i, 7, 10, QChar('0')), syntheticContent(i));
+}
+
+}
+
+namespace KWallet {
+
+Wallet::Wallet() :
+    updateTimer_(nullptr)
+{
+    {
+        QMutexLocker lock(&storage->mutex);
+        storage->wallets.append(this);
+    }
+
+    const int interval = qEnvironmentVariableIntValue(UPDATES_VARIABLE);
+    if (interval > 0)
+    {
+        updateTimer_ = new QTimer(this);
+        updateTimer_->setInterval(interval);
+        connect(updateTimer_, &QTimer::timeout, this, &Wallet::onUpdateTimeout);
+    }
+}
+
+Wallet::~Wallet()
+{
+    QMutexLocker lock(&storage->mutex);
+    storage->wallets.removeOne(this);
+}
+
+const QString Wallet::NetworkWallet()
+{
+    return "kdewallet";
+}
+
+Wallet* Wallet::openWallet(const QString& name, WId w, OpenType ot)
+{
+    simulateLatency();
+    return new Wallet();
+}
+
+void Wallet::setSyntheticEntries(int count)
+{
+    QMutexLocker lock(&storage->mutex);
+    storage->folders.clear();
+    storage->syntheticEntries = count;
+}
+
+bool Wallet::isOpen() const
+{
+    return true;
+}
+
+bool Wallet::hasFolder(const QString& folder)
+{
+    simulateLatency();
+
+    QMutexLocker lock(&storage->mutex);
+    return storage->folders.contains(folder);
+}
+
+bool Wallet::createFolder(const QString& folder)
+{
+    simulateLatency();
+
+    QMutexLocker lock(&storage->mutex);
+    if (!storage->folders.contains(folder))
+        populate(storage->folders[folder], storage->syntheticEntries);
+    return true;
+}
+
+bool Wallet::setFolder(const QString& folder)
+{
+    simulateLatency();
+
+    QMutexLocker lock(&storage->mutex);
+    if (!storage->folders.contains(folder))
+        return false;
+
+    folder_ = folder;
+    if (updateTimer_)
+        updateTimer_->start();
+    return true;
+}
+
+QStringList Wallet::entryList()
+{
+    simulateLatency();
+
+    QMutexLocker lock(&storage->mutex);
+    return storage->folders.value(folder_).keys();
+}
+
+bool Wallet::hasEntry(const QString& key)
+{
+    simulateLatency();
+
+    QMutexLocker lock(&storage->mutex);
+    return storage->folders.value(folder_).contains(key);
+}
+
+int Wallet::readEntry(const QString& key, QByteArray& value)
+{
+    simulateLatency();
+
+    QMutexLocker lock(&storage->mutex);
+    const Folder& folder = storage->folders[folder_];
+
+    auto it = folder.constFind(key);
+    if (it == folder.constEnd())
+        return -1;
+
+    value = it.value();
+    return 0;
+}
+
+int Wallet::writeEntry(const QString& key, const QByteArray& value, EntryType entryType)
+{
+    simulateLatency();
+
+    {
+        QMutexLocker lock(&storage->mutex);
+        storage->folders[folder_].insert(key, value);
+    }
+
+    notify(folder_);
+    return 0;
+}
+
+int Wallet::removeEntry(const QString& key)
+{
+    simulateLatency();
+
+    {
+        QMutexLocker lock(&storage->mutex);
+        storage->folders[folder_].remove(key);
+    }
+
+    notify(folder_);
+    return 0;
+}
+
+int Wallet::renameEntry(const QString& oldName, const QString& newName)
+{
+    simulateLatency();
+
+    {
+        QMutexLocker lock(&storage->mutex);
+        Folder& folder = storage->folders[folder_];
+        if (!folder.contains(oldName) || folder.contains(newName))
+            return -1;
+
+        folder.insert(newName, folder.take(oldName));
+    }
+
+    notify(folder_);
+    return 0;
+}
+
+void Wallet::notify(const QString& folder)
+{
+    // the wallets may live in other threads, their receivers get queued calls
+    QMutexLocker lock(&storage->mutex);
+    for (Wallet* wallet : storage->wallets)
+        emit wallet->folderUpdated(folder);
+}
+
+void Wallet::onUpdateTimeout()
+{
+    // another application rewriting a few entries, seen as external changes
+    {
+        QMutexLocker lock(&storage->mutex);
+        int n = storage->externalWrites++;
+        storage->folders[folder_].insert(QString("external-%1").arg(n % EXTERNAL_ENTRIES), syntheticContent(n));
+    }
+
+    notify(folder_);
+}
+
+}
@@ -0,0 +1,100 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FAKE_KWALLET_H
+#define FAKE_KWALLET_H
+
+#include <QObject>
+#include <QStringList>
+#include <QByteArray>
+#include <QWidget>
+
+class QTimer;
+
+// In-process stand-in for the parts of KWallet used by the wallet backend.
+//
+// The entries live in memory and are shared by all instances, so no wallet
+// daemon is needed. The environment variables
+//   PASSWORDMGR_FAKE_WALLET_LATENCY  delay of every call in microseconds
+//   PASSWORDMGR_FAKE_WALLET_ENTRIES  number of synthetic entries to start with
+//   PASSWORDMGR_FAKE_WALLET_UPDATES  interval in milliseconds of simulated
+//                                    changes by another application
+// allow measuring the model against large and slow wallets. Like the wallet
+// daemon, every change is announced to all open wallets.
+namespace KWallet {
+
+class Wallet : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum OpenType
+    {
+        Synchronous = 0,
+        Asynchronous,
+        Path,
+    };
+
+    enum EntryType
+    {
+        Unknown = 0,
+        Password,
+        Stream,
+        Map,
+    };
+
+    virtual ~Wallet();
+
+    static const QString NetworkWallet();
+    static Wallet* openWallet(const QString& name, WId w, OpenType ot = Synchronous);
+
+    // not part of KWallet: drops all folders, folders created afterwards start
+    // with count synthetic entries instead of PASSWORDMGR_FAKE_WALLET_ENTRIES
+    static void setSyntheticEntries(int count);
+
+    bool isOpen() const;
+
+    bool hasFolder(const QString& folder);
+    bool createFolder(const QString& folder);
+    bool setFolder(const QString& folder);
+
+    QStringList entryList();
+    bool hasEntry(const QString& key);
+    int readEntry(const QString& key, QByteArray& value);
+    int writeEntry(const QString& key, const QByteArray& value, EntryType entryType = Stream);
+    int removeEntry(const QString& key);
+    int renameEntry(const QString& oldName, const QString& newName);
+
+signals:
+    void walletClosed();
+    void folderUpdated(const QString& folder);
+
+private slots:
+    void onUpdateTimeout();
+
+private:
+    QString folder_;
+    QTimer* updateTimer_;
+
+    Wallet();
+
+    static void notify(const QString& folder);
+};
+
+}
+
+#endif // FAKE_KWALLET_H
@@ -0,0 +1,106 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "AuditDialog.h"
+
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+namespace {
+
+const int EntryRole = Qt::UserRole + 1;
+
+}
+
+AuditDialog::AuditDialog(const QString& title, QWidget* parent) :
+    QDialog(parent),
+    summary_(new QLabel(this)),
+    findings_(new QTreeWidget(this))
+{
+    setWindowTitle(title);
+    setAttribute(Qt::WA_DeleteOnClose);
+
+    findings_->setColumnCount(2);
+    findings_->setHeaderLabels(QStringList() << tr("Entry") << tr("Username"));
+    findings_->header()->setSectionResizeMode(QHeaderView::Stretch);
+    findings_->setUniformRowHeights(true);
+
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    connect(findings_, &QTreeWidget::itemDoubleClicked, this, [this](QTreeWidgetItem* item) {
+        const QString entry = item->data(0, EntryRole).toString();
+        if (!entry.isEmpty())
+            emit entryActivated(entry);
+    });
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->addWidget(summary_);
+    layout->addWidget(findings_);
+    layout->addWidget(buttons);
+
+    resize(600, 400);
+}
+
+void AuditDialog::setSummary(const QString& text)
+{
+    summary_->setText(text);
+}
+
+void AuditDialog::setDetailHeader(const QString& header)
+{
+    findings_->setColumnCount(3);
+    findings_->setHeaderLabels(QStringList() << tr("Entry") << tr("Username") << header);
+
+    // the lowest details, the worst findings, first unless sorted otherwise
+    if (!findings_->isSortingEnabled())
+    {
+        findings_->setSortingEnabled(true);
+        findings_->sortByColumn(2, Qt::AscendingOrder);
+    }
+}
+
+QTreeWidgetItem* AuditDialog::addFinding(const QString& text)
+{
+    QTreeWidgetItem* item = new QTreeWidgetItem(findings_, QStringList(text));
+    item->setFirstColumnSpanned(true);
+    return item;
+}
+
+QTreeWidgetItem* AuditDialog::finding(const QString& text)
+{
+    for (int i = 0; i < findings_->topLevelItemCount(); ++i)
+    {
+        QTreeWidgetItem* item = findings_->topLevelItem(i);
+        if (item->text(0) == text)
+            return item;
+    }
+    return addFinding(text);
+}
+
+void AuditDialog::addCredential(QTreeWidgetItem* finding, const QString& entry, const QString& username,
+                                const QVariant& detail)
+{
+    QTreeWidgetItem* item = new QTreeWidgetItem(finding, QStringList() << entry << username);
+    item->setData(0, EntryRole, entry);
+    // numbers are compared as such when sorting
+    if (detail.isValid())
+        item->setData(2, Qt::DisplayRole, detail);
+}
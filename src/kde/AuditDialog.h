@@ -0,0 +1,57 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AUDITDIALOG_H
+#define AUDITDIALOG_H
+
+#include <QDialog>
+#include <QVariant>
+
+class QLabel;
+class QTreeWidget;
+class QTreeWidgetItem;
+
+// Lists the findings of a wallet audit with the affected credentials below
+// each of them. Double clicking a credential selects its entry.
+//
+// A detail column, e.g. a score, is shown when it has a header; the
+// credentials are sortable by every column then.
+class AuditDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    AuditDialog(const QString& title, QWidget* parent = nullptr);
+
+    void setSummary(const QString& text);
+    void setDetailHeader(const QString& header);
+
+    QTreeWidgetItem* addFinding(const QString& text);
+    // the finding with the text, it is added if there is none yet
+    QTreeWidgetItem* finding(const QString& text);
+    void addCredential(QTreeWidgetItem* finding, const QString& entry, const QString& username,
+                       const QVariant& detail = QVariant());
+
+signals:
+    void entryActivated(const QString& entry);
+
+private:
+    QLabel* summary_;
+    QTreeWidget* findings_;
+};
+
+#endif // AUDITDIALOG_H
@@ -0,0 +1,84 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "BreachAudit.h"
+#include "AuditDialog.h"
+#include "../BreachChecker.h"
+
+#include <QCryptographicHash>
+#include <QMutexLocker>
+#include <algorithm>
+
+BreachAudit::BreachAudit(const BreachChecker* checker, WalletModel* model, QObject* parent) :
+    WalletAudit(model, parent),
+    checker_(checker)
+{
+}
+
+BreachAudit::~BreachAudit()
+{
+    wait();
+}
+
+QString BreachAudit::title() const
+{
+    return tr("Breached passwords");
+}
+
+void BreachAudit::report(AuditDialog* dialog) const
+{
+    dialog->setSummary(breached_.isEmpty()
+                       ? tr("No password is known from data breaches")
+                       : tr("%n password(s) known from data breaches", "", breached_.size()));
+
+    if (breached_.isEmpty())
+        return;
+
+    QTreeWidgetItem* finding = dialog->addFinding(tr("Found in the breach corpus"));
+    for (const Credential& credential : breached_)
+        dialog->addCredential(finding, credential.entry, credential.username);
+}
+
+void BreachAudit::prepare()
+{
+    breached_.clear();
+}
+
+void BreachAudit::check(const QString& entry, const WalletContentView& content)
+{
+    for (int i = 0; i < content.size(); ++i)
+    {
+        const QByteArray password = content.passwordUtf8(i);
+        if (password.isEmpty())
+            continue;
+
+        const QByteArray hash = QCryptographicHash::hash(password, QCryptographicHash::Sha1);
+        if (!checker_->containsHash(reinterpret_cast<const uchar*>(hash.constData())))
+            continue;
+
+        QMutexLocker locker(&mutex_);
+        breached_ << Credential{ entry, content.username(i) };
+    }
+}
+
+void BreachAudit::complete()
+{
+    // the tasks finish in any order
+    std::sort(breached_.begin(), breached_.end(), [](const Credential& a, const Credential& b) {
+        return a.entry != b.entry ? a.entry < b.entry : a.username < b.username;
+    });
+}
@@ -0,0 +1,52 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BREACHAUDIT_H
+#define BREACHAUDIT_H
+
+#include "WalletAudit.h"
+#include <QMutex>
+
+class BreachChecker;
+
+// Finds credentials whose password appears in the corpus of breached
+// passwords. The corpus is only read, so the checks run unsynchronized.
+class BreachAudit : public WalletAudit
+{
+    Q_OBJECT
+
+public:
+    BreachAudit(const BreachChecker* checker, WalletModel* model, QObject* parent = nullptr);
+    virtual ~BreachAudit();
+
+    QString title() const override;
+    void report(AuditDialog* dialog) const override;
+
+    QList<Credential> breached() const { return breached_; }
+
+protected:
+    void prepare() override;
+    void check(const QString& entry, const WalletContentView& content) override;
+    void complete() override;
+
+private:
+    const BreachChecker* checker_;
+    QMutex mutex_;
+    QList<Credential> breached_;
+};
+
+#endif // BREACHAUDIT_H
@@ -0,0 +1,217 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CredentialModel.h"
+
+#include <QLineEdit>
+
+namespace {
+
+const QChar PASSWORD_MASK(0x2022);
+
+}
+
+CredentialModel::CredentialModel(QObject* parent) :
+    QAbstractTableModel(parent),
+    edited_(false),
+    passwordsVisible_(false)
+{
+}
+
+CredentialModel::~CredentialModel()
+{
+}
+
+WalletContentList CredentialModel::content() const
+{
+    WalletContentList content;
+    for (const WalletContent& c : edited_ ? content_ : view_.toList())
+    {
+        if (!c.username().isEmpty() || !c.password().isEmpty())
+            content << c;
+    }
+    return content;
+}
+
+void CredentialModel::setContent(const WalletContentView& content)
+{
+    beginResetModel();
+    view_ = content;
+    content_.clear();
+    edited_ = false;
+    endResetModel();
+}
+
+WalletContent CredentialModel::credential(int row) const
+{
+    return edited_ ? content_[row] : view_.at(row);
+}
+
+void CredentialModel::setPasswordsVisible(bool visible)
+{
+    if (visible == passwordsVisible_)
+        return;
+
+    passwordsVisible_ = visible;
+    if (rowCount() > 0)
+        emit dataChanged(index(0, PasswordColumn), index(rowCount() - 1, PasswordColumn),
+                         QVector<int>({Qt::DisplayRole}));
+}
+
+int CredentialModel::appendCredential()
+{
+    detach();
+    int row = content_.size();
+
+    beginInsertRows(QModelIndex(), row, row);
+    content_ << WalletContent();
+    endInsertRows();
+
+    return row;
+}
+
+Qt::ItemFlags CredentialModel::flags(const QModelIndex& index) const
+{
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsEditable;
+}
+
+int CredentialModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return edited_ ? content_.size() : view_.size();
+}
+
+int CredentialModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant CredentialModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole)
+        return QVariant();
+
+    if (orientation == Qt::Vertical)
+        return tr("#%1").arg(section);
+
+    return section == UsernameColumn ? tr("Username") : tr("Password");
+}
+
+QVariant CredentialModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid())
+        return QVariant();
+
+    if (role == Qt::EditRole)
+        return field(index.row(), index.column());
+
+    if (role == Qt::DisplayRole)
+    {
+        const QString text = field(index.row(), index.column());
+        if (index.column() == UsernameColumn || passwordsVisible_)
+            return text;
+        return QString(text.size(), PASSWORD_MASK);
+    }
+
+    return QVariant();
+}
+
+bool CredentialModel::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+    if (!index.isValid() || role != Qt::EditRole)
+        return false;
+
+    detach();
+    WalletContent& c = content_[index.row()];
+    const QString text = value.toString();
+
+    if (index.column() == UsernameColumn)
+    {
+        if (text == c.username())
+            return true;
+        c = WalletContent(text, c.password());
+    }
+    else
+    {
+        if (text == c.password())
+            return true;
+        c = WalletContent(c.username(), text);
+    }
+
+    emit dataChanged(index, index);
+    emit contentEdited();
+    return true;
+}
+
+bool CredentialModel::removeRows(int row, int count, const QModelIndex& parent)
+{
+    if (parent.isValid() || row < 0 || count <= 0 || row + count > rowCount())
+        return false;
+
+    detach();
+    beginRemoveRows(QModelIndex(), row, row + count - 1);
+    content_.erase(content_.begin() + row, content_.begin() + row + count);
+    endRemoveRows();
+
+    emit contentEdited();
+    return true;
+}
+
+QString CredentialModel::field(int row, int column) const
+{
+    if (edited_)
+        return column == UsernameColumn ? content_[row].username() : content_[row].password();
+    return column == UsernameColumn ? view_.username(row) : view_.password(row);
+}
+
+void CredentialModel::detach()
+{
+    if (edited_)
+        return;
+
+    content_ = view_.toList();
+    view_ = WalletContentView();
+    edited_ = true;
+}
+
+CredentialDelegate::CredentialDelegate(QObject* parent) :
+    QStyledItemDelegate(parent)
+{
+}
+
+QWidget* CredentialDelegate::createEditor(QWidget* parent, const QStyleOptionViewItem& option,
+                                          const QModelIndex& index) const
+{
+    QWidget* editor = QStyledItemDelegate::createEditor(parent, option, index);
+
+    QLineEdit* lineEdit = qobject_cast<QLineEdit*>(editor);
+    const CredentialModel* model = qobject_cast<const CredentialModel*>(index.model());
+    if (lineEdit && model)
+    {
+        if (index.column() == CredentialModel::UsernameColumn)
+        {
+            lineEdit->setPlaceholderText(tr("Username"));
+        }
+        else
+        {
+            lineEdit->setPlaceholderText(tr("Password"));
+            lineEdit->setEchoMode(model->passwordsVisible() ? QLineEdit::Normal : QLineEdit::Password);
+        }
+    }
+    return editor;
+}
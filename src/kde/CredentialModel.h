@@ -0,0 +1,87 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CREDENTIALMODEL_H
+#define CREDENTIALMODEL_H
+
+#include "WalletContent.h"
+#include <QAbstractTableModel>
+#include <QStyledItemDelegate>
+
+// Credentials of the selected wallet entry, one row per credential. The
+// fields are decoded per cell until the credentials are edited.
+class CredentialModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column
+    {
+        UsernameColumn,
+        PasswordColumn,
+        ColumnCount
+    };
+
+    CredentialModel(QObject* parent = nullptr);
+    virtual ~CredentialModel();
+
+    // rows with neither username nor password are left out
+    WalletContentList content() const;
+    void setContent(const WalletContentView& content);
+
+    bool passwordsVisible() const { return passwordsVisible_; }
+    void setPasswordsVisible(bool visible);
+
+    int appendCredential();
+    WalletContent credential(int row) const;
+
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    bool setData(const QModelIndex& index, const QVariant& value, int role) override;
+    bool removeRows(int row, int count, const QModelIndex& parent = QModelIndex()) override;
+
+signals:
+    // emitted for changes made through setData() or removeRows() only
+    void contentEdited();
+
+private:
+    WalletContentView view_;
+    // copy of the view made by the first edit
+    WalletContentList content_;
+    bool edited_;
+    bool passwordsVisible_;
+
+    QString field(int row, int column) const;
+    void detach();
+};
+
+// Edits the credentials in place, passwords are entered masked unless they are shown.
+class CredentialDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    CredentialDelegate(QObject* parent = nullptr);
+
+    QWidget* createEditor(QWidget* parent, const QStyleOptionViewItem& option,
+                          const QModelIndex& index) const override;
+};
+
+#endif // CREDENTIALMODEL_H
@@ -0,0 +1,67 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "EntrySnapshot.h"
+
+#include <QDataStream>
+
+EntrySnapshot::EntrySnapshot() :
+    file_("entries.snapshot"),
+    enabled_(false)
+{
+}
+
+void EntrySnapshot::setEnabled(bool enabled)
+{
+    enabled_ = enabled;
+    if (!enabled_)
+        file_.remove();
+}
+
+QStringList EntrySnapshot::load()
+{
+    entries_.clear();
+    if (!enabled_)
+        return entries_;
+
+    QByteArray data;
+    if (!file_.read(data))
+        return entries_;
+
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    QStringList entries;
+    stream >> entries;
+    if (stream.status() == QDataStream::Ok)
+        entries_.swap(entries);
+    return entries_;
+}
+
+void EntrySnapshot::save(const QStringList& entries)
+{
+    if (!enabled_ || entries == entries_)
+        return;
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << entries;
+
+    if (file_.write(data))
+        entries_ = entries;
+}
@@ -0,0 +1,45 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENTRYSNAPSHOT_H
+#define ENTRYSNAPSHOT_H
+
+#include "StateFile.h"
+#include <QStringList>
+
+// Sorted entry names of the last session, shown at startup until the wallet
+// is open. The names are stored in plain text, so the snapshot is off unless
+// the setting wallet/entrySnapshot is true.
+class EntrySnapshot
+{
+public:
+    EntrySnapshot();
+
+    // a disabled snapshot removes its file, load() returns no entries
+    void setEnabled(bool enabled);
+
+    QStringList load();
+    void save(const QStringList& entries);
+
+private:
+    StateFile file_;
+    bool enabled_;
+    // list of the last load() or save(), unchanged lists are not written again
+    QStringList entries_;
+};
+
+#endif // ENTRYSNAPSHOT_H
@@ -0,0 +1,203 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "EntryUsage.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace {
+
+// number of remembered entries
+const int MAX_ENTRIES = 256;
+
+// time in seconds after which a use counts half
+const double HALF_LIFE = 7 * 24 * 3600;
+
+// time in ms after the last change until the usage is written
+const int SAVE_DELAY = 2000;
+
+const quint8 VERSION = 1;
+
+qint64 now()
+{
+    return QDateTime::currentMSecsSinceEpoch() / 1000;
+}
+
+double decayed(double count, qint64 lastUsed, qint64 time)
+{
+    return count * std::exp2(-double(time - lastUsed) / HALF_LIFE);
+}
+
+}
+
+EntryUsage::EntryUsage(QObject* parent) :
+    QObject(parent),
+    file_("usage.bin"),
+    persistent_(false)
+{
+    saveTimer_.setSingleShot(true);
+    saveTimer_.setInterval(SAVE_DELAY);
+    connect(&saveTimer_, &QTimer::timeout, this, &EntryUsage::save);
+}
+
+EntryUsage::~EntryUsage()
+{
+    if (saveTimer_.isActive())
+        save();
+}
+
+void EntryUsage::setPersistent(bool persistent)
+{
+    persistent_ = persistent;
+    if (persistent_)
+    {
+        load();
+    }
+    else
+    {
+        saveTimer_.stop();
+        file_.remove();
+    }
+}
+
+void EntryUsage::use(const QString& entry)
+{
+    const qint64 time = now();
+
+    auto it = index_.find(entry);
+    if (it != index_.end())
+    {
+        UsageList::iterator usage = it.value();
+        usage->count = decayed(usage->count, usage->lastUsed, time) + 1;
+        usage->lastUsed = time;
+        entries_.splice(entries_.begin(), entries_, usage);
+    }
+    else
+    {
+        entries_.push_front(Usage{ entry, time, 1 });
+        index_.insert(entry, entries_.begin());
+
+        if (entries_.size() > size_t(MAX_ENTRIES))
+        {
+            index_.remove(entries_.back().entry);
+            entries_.pop_back();
+        }
+    }
+
+    saveTimer_.start();
+    emit changed();
+}
+
+void EntryUsage::rename(const QString& oldName, const QString& newName)
+{
+    if (!index_.contains(oldName) || oldName == newName)
+        return;
+
+    // a remembered entry of that name must have been removed by another client
+    remove(newName);
+
+    UsageList::iterator usage = index_.take(oldName);
+    usage->entry = newName;
+    index_.insert(newName, usage);
+
+    saveTimer_.start();
+    emit changed();
+}
+
+void EntryUsage::remove(const QString& entry)
+{
+    auto it = index_.find(entry);
+    if (it == index_.end())
+        return;
+
+    entries_.erase(it.value());
+    index_.erase(it);
+
+    saveTimer_.start();
+    emit changed();
+}
+
+QStringList EntryUsage::ranked() const
+{
+    const qint64 time = now();
+
+    QVector<QPair<double, QString>> scores;
+    scores.reserve(index_.size());
+    for (const Usage& usage : entries_)
+        scores << qMakePair(decayed(usage.count, usage.lastUsed, time), usage.entry);
+
+    // the list is ordered by recency, which decides between equal counts
+    std::stable_sort(scores.begin(), scores.end(),
+                     [](const QPair<double, QString>& a, const QPair<double, QString>& b) {
+        return a.first > b.first;
+    });
+
+    QStringList entries;
+    entries.reserve(scores.size());
+    for (const auto& score : scores)
+        entries << score.second;
+    return entries;
+}
+
+void EntryUsage::load()
+{
+    QByteArray data;
+    if (!file_.read(data))
+        return;
+
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    quint8 version;
+    quint32 count;
+    stream >> version >> count;
+    if (version != VERSION)
+        return;
+
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok && index_.size() < MAX_ENTRIES; ++i)
+    {
+        Usage usage;
+        stream >> usage.entry >> usage.lastUsed >> usage.count;
+        if (stream.status() != QDataStream::Ok || index_.contains(usage.entry))
+            continue;
+
+        entries_.push_back(usage);
+        index_.insert(usage.entry, std::prev(entries_.end()));
+    }
+}
+
+void EntryUsage::save()
+{
+    saveTimer_.stop();
+    if (!persistent_)
+        return;
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    stream << VERSION << quint32(entries_.size());
+    for (const Usage& usage : entries_)
+        stream << usage.entry << usage.lastUsed << usage.count;
+
+    file_.write(data);
+}
@@ -0,0 +1,78 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENTRYUSAGE_H
+#define ENTRYUSAGE_H
+
+#include "StateFile.h"
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+#include <list>
+
+// Last use and a decaying use count of the recently used entries.
+//
+// The entries are kept in a list ordered by their last use together with a
+// hash into that list, recording a use is O(1). The count halves every week,
+// so entries used often and lately rank first. Only the most recently used
+// entries are remembered.
+class EntryUsage : public QObject
+{
+    Q_OBJECT
+
+public:
+    EntryUsage(QObject* parent = nullptr);
+    virtual ~EntryUsage();
+
+    // the uses are read from and written to a plain text file, otherwise they
+    // are only kept for the session and an existing file is removed
+    void setPersistent(bool persistent);
+
+    void use(const QString& entry);
+    void rename(const QString& oldName, const QString& newName);
+    void remove(const QString& entry);
+
+    // remembered entries, highest decayed use count first
+    QStringList ranked() const;
+
+signals:
+    void changed();
+
+private:
+    struct Usage
+    {
+        QString entry;
+        // seconds since the epoch
+        qint64 lastUsed;
+        double count;
+    };
+    typedef std::list<Usage> UsageList;
+
+    // most recently used first
+    UsageList entries_;
+    QHash<QString, UsageList::iterator> index_;
+    StateFile file_;
+    bool persistent_;
+    // uses are written after a short delay, all of them in one go
+    QTimer saveTimer_;
+
+    void load();
+    void save();
+};
+
+#endif // ENTRYUSAGE_H
@@ -0,0 +1,91 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "KWalletBackend.h"
+#include "WalletWorker.h"
+#include <kwallet.h>
+
+WalletBackend* createWalletBackend()
+{
+    return new KWalletBackend();
+}
+
+KWalletBackend::KWalletBackend() :
+    wallet_(nullptr)
+{
+}
+
+KWalletBackend::~KWalletBackend()
+{
+    delete wallet_;
+}
+
+bool KWalletBackend::open(WId window)
+{
+    if (isOpen())
+        return true;
+
+    delete wallet_;
+    wallet_ = KWallet::Wallet::openWallet(KWallet::Wallet::NetworkWallet(), window,
+        KWallet::Wallet::Synchronous);
+    if (!wallet_)
+        return false;
+
+    connect(wallet_, &KWallet::Wallet::walletClosed, this, &KWalletBackend::onWalletClosed);
+    connect(wallet_, &KWallet::Wallet::folderUpdated, this, &WalletBackend::folderUpdated);
+
+    return (wallet_->hasFolder(PASSWORD_MANAGER_FOLDER) ||
+        wallet_->createFolder(PASSWORD_MANAGER_FOLDER)) &&
+        wallet_->setFolder(PASSWORD_MANAGER_FOLDER);
+}
+
+bool KWalletBackend::isOpen() const
+{
+    return wallet_ && wallet_->isOpen();
+}
+
+QStringList KWalletBackend::entryList()
+{
+    return wallet_ ? wallet_->entryList() : QStringList();
+}
+
+bool KWalletBackend::readEntry(const QString& key, QByteArray& value)
+{
+    return wallet_ && wallet_->readEntry(key, value) == 0;
+}
+
+bool KWalletBackend::writeEntry(const QString& key, const QByteArray& value)
+{
+    return wallet_ && wallet_->writeEntry(key, value, KWallet::Wallet::Stream) == 0;
+}
+
+bool KWalletBackend::removeEntry(const QString& key)
+{
+    return wallet_ && wallet_->removeEntry(key) == 0;
+}
+
+bool KWalletBackend::renameEntry(const QString& oldKey, const QString& newKey)
+{
+    return wallet_ && wallet_->renameEntry(oldKey, newKey) == 0;
+}
+
+void KWalletBackend::onWalletClosed()
+{
+    wallet_->deleteLater();
+    wallet_ = nullptr;
+    emit closed();
+}
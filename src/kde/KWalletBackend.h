@@ -0,0 +1,51 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KWALLETBACKEND_H
+#define KWALLETBACKEND_H
+
+#include "WalletBackend.h"
+
+namespace KWallet {
+class Wallet;
+}
+
+class KWalletBackend : public WalletBackend
+{
+    Q_OBJECT
+
+public:
+    KWalletBackend();
+    virtual ~KWalletBackend();
+
+    bool open(WId window) override;
+    bool isOpen() const override;
+
+    QStringList entryList() override;
+    bool readEntry(const QString& key, QByteArray& value) override;
+    bool writeEntry(const QString& key, const QByteArray& value) override;
+    bool removeEntry(const QString& key) override;
+    bool renameEntry(const QString& oldKey, const QString& newKey) override;
+
+private slots:
+    void onWalletClosed();
+
+private:
+    KWallet::Wallet* wallet_;
+};
+
+#endif // KWALLETBACKEND_H
@@ -0,0 +1,96 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "PasswordReuseAudit.h"
+#include "AuditDialog.h"
+#include "../CipherStream.h"
+
+#include <QMutexLocker>
+#include <algorithm>
+
+PasswordReuseAudit::PasswordReuseAudit(WalletModel* model, QObject* parent) :
+    WalletAudit(model, parent)
+{
+}
+
+PasswordReuseAudit::~PasswordReuseAudit()
+{
+    wait();
+}
+
+QString PasswordReuseAudit::title() const
+{
+    return tr("Reused passwords");
+}
+
+void PasswordReuseAudit::report(AuditDialog* dialog) const
+{
+    dialog->setSummary(groups_.isEmpty()
+                       ? tr("No password is used more than once")
+                       : tr("%n password(s) used more than once", "", groups_.size()));
+
+    for (const Group& group : groups_)
+    {
+        QTreeWidgetItem* finding = dialog->addFinding(tr("Used %n times", "", group.size()));
+        for (const Credential& credential : group)
+            dialog->addCredential(finding, credential.entry, credential.username);
+    }
+}
+
+void PasswordReuseAudit::prepare()
+{
+    groups_.clear();
+
+    // a new key for every audit, the hashes are worthless afterwards
+    hash_.reset(new SipHash(CipherStream::randomBytes(SipHash::KEY_LENGTH)));
+}
+
+void PasswordReuseAudit::check(const QString& entry, const WalletContentView& content)
+{
+    for (int i = 0; i < content.size(); ++i)
+    {
+        // hashed straight from the blob, the password is never decoded
+        const QByteArray password = content.passwordUtf8(i);
+        if (password.isEmpty())
+            continue;
+
+        const quint64 hash = hash_->hash(password);
+        Shard& shard = shards_[hash % SHARD_COUNT];
+
+        QMutexLocker locker(&shard.mutex);
+        shard.buckets[hash] << Credential{ entry, content.username(i) };
+    }
+}
+
+void PasswordReuseAudit::complete()
+{
+    for (Shard& shard : shards_)
+    {
+        for (const Group& group : shard.buckets)
+        {
+            if (group.size() > 1)
+                groups_ << group;
+        }
+        shard.buckets.clear();
+    }
+
+    std::sort(groups_.begin(), groups_.end(), [](const Group& a, const Group& b) {
+        return a.size() != b.size() ? a.size() > b.size() : a.first().entry < b.first().entry;
+    });
+
+    hash_.reset();
+}
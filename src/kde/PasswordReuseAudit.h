@@ -0,0 +1,66 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PASSWORDREUSEAUDIT_H
+#define PASSWORDREUSEAUDIT_H
+
+#include "SipHash.h"
+#include "WalletAudit.h"
+#include <QHash>
+#include <QMutex>
+#include <QScopedPointer>
+
+// Finds credentials sharing the same password across the whole wallet.
+//
+// Only keyed hashes of the passwords are kept, in a map split into shards
+// with a lock each, so the checking threads rarely wait for each other.
+class PasswordReuseAudit : public WalletAudit
+{
+    Q_OBJECT
+
+public:
+    typedef QVector<Credential> Group;
+
+    PasswordReuseAudit(WalletModel* model, QObject* parent = nullptr);
+    virtual ~PasswordReuseAudit();
+
+    QString title() const override;
+    void report(AuditDialog* dialog) const override;
+
+    // credentials sharing a password, largest groups first
+    QList<Group> groups() const { return groups_; }
+
+protected:
+    void prepare() override;
+    void check(const QString& entry, const WalletContentView& content) override;
+    void complete() override;
+
+private:
+    static constexpr int SHARD_COUNT = 16;
+
+    struct Shard
+    {
+        QMutex mutex;
+        QHash<quint64, Group> buckets;
+    };
+
+    QScopedPointer<SipHash> hash_;
+    Shard shards_[SHARD_COUNT];
+    QList<Group> groups_;
+};
+
+#endif // PASSWORDREUSEAUDIT_H
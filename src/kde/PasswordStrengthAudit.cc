@@ -0,0 +1,98 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "PasswordStrengthAudit.h"
+#include "AuditDialog.h"
+#include "../PasswordStrength.h"
+
+#include <QMutexLocker>
+
+namespace {
+
+const int MIN_LENGTH = 10;
+// about a random password of ten letters and digits
+const int MIN_ENTROPY = 50;
+
+}
+
+PasswordStrengthAudit::PasswordStrengthAudit(WalletModel* model, QObject* parent) :
+    WalletAudit(model, parent),
+    reported_(0)
+{
+}
+
+PasswordStrengthAudit::~PasswordStrengthAudit()
+{
+    wait();
+}
+
+QString PasswordStrengthAudit::title() const
+{
+    return tr("Weak passwords");
+}
+
+void PasswordStrengthAudit::reportChecked(AuditDialog* dialog)
+{
+    QList<Finding> findings;
+    {
+        QMutexLocker locker(&mutex_);
+        findings = findings_.mid(reported_);
+        reported_ = findings_.size();
+    }
+
+    if (findings.isEmpty())
+        return;
+
+    dialog->setDetailHeader(tr("Entropy (bits)"));
+    for (const Finding& finding : findings)
+    {
+        QTreeWidgetItem* item = dialog->finding(finding.length < MIN_LENGTH
+                                                ? tr("Shorter than %n characters", "", MIN_LENGTH)
+                                                : tr("Easy to guess"));
+        dialog->addCredential(item, finding.credential.entry, finding.credential.username, finding.entropy);
+    }
+}
+
+void PasswordStrengthAudit::report(AuditDialog* dialog) const
+{
+    dialog->setSummary(findings_.isEmpty()
+                       ? tr("No weak password found")
+                       : tr("%n weak password(s) found", "", findings_.size()));
+}
+
+void PasswordStrengthAudit::prepare()
+{
+    findings_.clear();
+    reported_ = 0;
+}
+
+void PasswordStrengthAudit::check(const QString& entry, const WalletContentView& content)
+{
+    for (int i = 0; i < content.size(); ++i)
+    {
+        const QString password = content.password(i);
+        if (password.isEmpty())
+            continue;
+
+        const int entropy = passwordEntropy(password);
+        if (password.size() >= MIN_LENGTH && entropy >= MIN_ENTROPY)
+            continue;
+
+        QMutexLocker locker(&mutex_);
+        findings_ << Finding{ Credential{ entry, content.username(i) }, password.size(), entropy };
+    }
+}
@@ -0,0 +1,56 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PASSWORDSTRENGTHAUDIT_H
+#define PASSWORDSTRENGTHAUDIT_H
+
+#include "WalletAudit.h"
+#include <QMutex>
+
+// Finds short passwords and passwords with a low estimated entropy. The
+// findings are shown while the audit is still running.
+class PasswordStrengthAudit : public WalletAudit
+{
+    Q_OBJECT
+
+public:
+    struct Finding
+    {
+        Credential credential;
+        int length;
+        int entropy;
+    };
+
+    PasswordStrengthAudit(WalletModel* model, QObject* parent = nullptr);
+    virtual ~PasswordStrengthAudit();
+
+    QString title() const override;
+    void reportChecked(AuditDialog* dialog) override;
+    void report(AuditDialog* dialog) const override;
+
+protected:
+    void prepare() override;
+    void check(const QString& entry, const WalletContentView& content) override;
+
+private:
+    QMutex mutex_;
+    QList<Finding> findings_;
+    // findings already passed to reportChecked()
+    int reported_;
+};
+
+#endif // PASSWORDSTRENGTHAUDIT_H
@@ -0,0 +1,77 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "SipHash.h"
+#include <QtEndian>
+
+namespace {
+
+inline quint64 rotl(quint64 x, int b)
+{
+    return (x << b) | (x >> (64 - b));
+}
+
+inline void sipRound(quint64& v0, quint64& v1, quint64& v2, quint64& v3)
+{
+    v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+    v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+    v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+    v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+}
+
+}
+
+SipHash::SipHash(const QByteArray& key)
+{
+    Q_ASSERT(key.size() == KEY_LENGTH);
+    k0_ = qFromLittleEndian<quint64>(key.constData());
+    k1_ = qFromLittleEndian<quint64>(key.constData() + 8);
+}
+
+quint64 SipHash::hash(const char* data, int size) const
+{
+    quint64 v0 = k0_ ^ 0x736f6d6570736575ULL;
+    quint64 v1 = k1_ ^ 0x646f72616e646f6dULL;
+    quint64 v2 = k0_ ^ 0x6c7967656e657261ULL;
+    quint64 v3 = k1_ ^ 0x7465646279746573ULL;
+
+    const char* end = data + (size & ~7);
+    for (; data != end; data += 8)
+    {
+        quint64 m = qFromLittleEndian<quint64>(data);
+        v3 ^= m;
+        sipRound(v0, v1, v2, v3);
+        sipRound(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+
+    // remaining bytes and the length in the last word
+    quint64 b = quint64(size) << 56;
+    for (int i = 0; i < (size & 7); ++i)
+        b |= quint64(quint8(data[i])) << (8 * i);
+
+    v3 ^= b;
+    sipRound(v0, v1, v2, v3);
+    sipRound(v0, v1, v2, v3);
+    v0 ^= b;
+
+    v2 ^= 0xff;
+    for (int i = 0; i < 4; ++i)
+        sipRound(v0, v1, v2, v3);
+
+    return v0 ^ v1 ^ v2 ^ v3;
+}
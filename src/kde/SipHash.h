@@ -0,0 +1,40 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIPHASH_H
+#define SIPHASH_H
+
+#include <QByteArray>
+
+// SipHash-2-4, a fast keyed hash. Without the key the hashes can not be
+// computed, so they do not allow to guess the hashed data.
+class SipHash
+{
+public:
+    static constexpr int KEY_LENGTH = 16;
+
+    explicit SipHash(const QByteArray& key);
+
+    quint64 hash(const char* data, int size) const;
+    quint64 hash(const QByteArray& data) const { return hash(data.constData(), data.size()); }
+
+private:
+    quint64 k0_;
+    quint64 k1_;
+};
+
+#endif // SIPHASH_H
@@ -0,0 +1,79 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "StateFile.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtEndian>
+
+namespace {
+
+const QByteArray MAGIC("PMST");
+const quint8 VERSION = 1;
+
+const int HEADER_SIZE = 4 + 1 + 2;
+
+}
+
+StateFile::StateFile(const QString& name)
+{
+    QDir dataDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+    fileName_ = dataDir.absolutePath() + QDir::separator() + name;
+}
+
+bool StateFile::read(QByteArray& data) const
+{
+    QFile file(fileName_);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const QByteArray raw = file.readAll();
+    if (raw.size() < HEADER_SIZE || !raw.startsWith(MAGIC) || quint8(raw.at(4)) != VERSION)
+        return false;
+
+    const quint16 checksum = qFromBigEndian<quint16>(raw.constData() + MAGIC.size() + 1);
+    data = raw.mid(HEADER_SIZE);
+    return qChecksum(data.constData(), data.size()) == checksum;
+}
+
+bool StateFile::write(const QByteArray& data)
+{
+    QByteArray header = MAGIC;
+    header.append(static_cast<char>(VERSION));
+    header.append(2, 0);
+    qToBigEndian<quint16>(qChecksum(data.constData(), data.size()), header.data() + MAGIC.size() + 1);
+
+    QDir().mkpath(QFileInfo(fileName_).absolutePath());
+
+    QSaveFile file(fileName_);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    file.setPermissions(QFile::ReadOwner | QFile::WriteOwner);
+    file.write(header);
+    file.write(data);
+    return file.commit();
+}
+
+void StateFile::remove()
+{
+    QFile::remove(fileName_);
+}
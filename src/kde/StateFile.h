@@ -0,0 +1,43 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef STATEFILE_H
+#define STATEFILE_H
+
+#include <QByteArray>
+#include <QString>
+
+// Small file in the data directory for state that has to be available before
+// the wallet is open. The data is stored in plain text with a checksum that
+// detects damaged files, only data that may be read by anyone with access to
+// the user account belongs here.
+//
+// File layout: magic, version, CRC-16 of the data and the data.
+class StateFile
+{
+public:
+    explicit StateFile(const QString& name);
+
+    bool read(QByteArray& data) const;
+    bool write(const QByteArray& data);
+    void remove();
+
+private:
+    QString fileName_;
+};
+
+#endif // STATEFILE_H
@@ -0,0 +1,227 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "TrigramIndex.h"
+
+#include <algorithm>
+
+namespace {
+
+// marks grams at the beginning of a word, used for queries shorter than a trigram
+const ushort WORD_START = 0xffff;
+
+// removed strings left in the postings before they are rebuilt
+const int COMPACT_THRESHOLD = 1024;
+
+quint64 gram(ushort a, ushort b, ushort c)
+{
+    return (quint64(a) << 32) | (quint64(b) << 16) | c;
+}
+
+bool isWordStart(const QString& text, int pos)
+{
+    return text[pos].isLetterOrNumber() && (pos == 0 || !text[pos - 1].isLetterOrNumber());
+}
+
+QString normalize(const QString& text)
+{
+    return text.trimmed().toCaseFolded();
+}
+
+// about two thirds of the query grams have to be found
+int requiredHits(int grams)
+{
+    return grams - grams / 3;
+}
+
+}
+
+TrigramIndex::TrigramIndex() :
+    removed_(0)
+{
+}
+
+void TrigramIndex::clear()
+{
+    postings_.clear();
+    ids_.clear();
+    texts_.clear();
+    hits_.clear();
+    removed_ = 0;
+}
+
+void TrigramIndex::insert(const QString& text)
+{
+    if (ids_.contains(text))
+        return;
+
+    int id = texts_.size();
+    texts_.append(text);
+    ids_.insert(text, id);
+
+    for (Gram g : textGrams(text))
+        postings_[g].append(id);
+}
+
+void TrigramIndex::remove(const QString& text)
+{
+    auto it = ids_.find(text);
+    if (it == ids_.end())
+        return;
+
+    // the postings are left untouched, stale ids are skipped by search()
+    texts_[it.value()] = QString();
+    ids_.erase(it);
+
+    ++removed_;
+    if (removed_ > COMPACT_THRESHOLD && removed_ * 2 > texts_.size())
+        compact();
+}
+
+QVector<TrigramIndex::Match> TrigramIndex::search(const QString& query) const
+{
+    QVector<Match> matches;
+
+    const QString q = normalize(query);
+    const QVector<Gram> grams = queryGrams(q);
+    if (grams.isEmpty())
+        return matches;
+
+    hits_.resize(texts_.size());
+
+    QVector<int> candidates;
+    for (Gram g : grams)
+    {
+        auto it = postings_.constFind(g);
+        if (it == postings_.constEnd())
+            continue;
+
+        for (int id : it.value())
+        {
+            if (hits_[id]++ == 0)
+                candidates.append(id);
+        }
+    }
+
+    const int required = requiredHits(grams.size());
+    for (int id : candidates)
+    {
+        int hits = hits_[id];
+        hits_[id] = 0;
+
+        const QString& text = texts_[id];
+        if (hits >= required && !text.isNull())
+            matches.append({ text, score(q, text, hits, grams.size()) });
+    }
+
+    return matches;
+}
+
+int TrigramIndex::match(const QString& query, const QString& text)
+{
+    const QString q = normalize(query);
+    const QVector<Gram> grams = queryGrams(q);
+    if (grams.isEmpty())
+        return -1;
+
+    const QVector<Gram> textGramList = textGrams(text);
+
+    int hits = 0;
+    for (Gram g : grams)
+    {
+        if (std::binary_search(textGramList.constBegin(), textGramList.constEnd(), g))
+            ++hits;
+    }
+
+    if (hits < requiredHits(grams.size()))
+        return -1;
+    return score(q, text, hits, grams.size());
+}
+
+void TrigramIndex::compact()
+{
+    QVector<QString> texts;
+    texts.reserve(ids_.size());
+    for (const QString& text : texts_)
+    {
+        if (!text.isNull())
+            texts.append(text);
+    }
+
+    clear();
+    for (const QString& text : texts)
+        insert(text);
+}
+
+QVector<TrigramIndex::Gram> TrigramIndex::textGrams(const QString& text)
+{
+    const QString s = text.toCaseFolded();
+    const int n = s.size();
+
+    QVector<Gram> grams;
+    grams.reserve(2 * n);
+
+    for (int i = 0; i + 2 < n; ++i)
+        grams.append(gram(s[i].unicode(), s[i + 1].unicode(), s[i + 2].unicode()));
+
+    for (int i = 0; i < n; ++i)
+    {
+        if (!isWordStart(s, i))
+            continue;
+
+        grams.append(gram(WORD_START, WORD_START, s[i].unicode()));
+        if (i + 1 < n)
+            grams.append(gram(WORD_START, s[i].unicode(), s[i + 1].unicode()));
+    }
+
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+QVector<TrigramIndex::Gram> TrigramIndex::queryGrams(const QString& query)
+{
+    QVector<Gram> grams;
+
+    // too short for a trigram, matches the beginnings of words
+    if (query.size() == 1)
+        grams.append(gram(WORD_START, WORD_START, query[0].unicode()));
+    else if (query.size() == 2)
+        grams.append(gram(WORD_START, query[0].unicode(), query[1].unicode()));
+
+    for (int i = 0; i + 2 < query.size(); ++i)
+        grams.append(gram(query[i].unicode(), query[i + 1].unicode(), query[i + 2].unicode()));
+
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+int TrigramIndex::score(const QString& query, const QString& text, int hits, int grams)
+{
+    int score = 4 * hits;
+
+    // exact substrings rank above fuzzy matches, prefixes above everything else
+    if (hits == grams)
+    {
+        if (text.startsWith(query, Qt::CaseInsensitive))
+            score += 2;
+        else if (text.contains(query, Qt::CaseInsensitive))
+            score += 1;
+    }
+    return score;
+}
@@ -0,0 +1,68 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// Maps the trigrams and word beginnings of a set of strings to the strings
+// containing them. A search only visits the strings sharing a trigram with
+// the query, strings missing some of the trigrams still match with a lower
+// score to tolerate typos.
+class TrigramIndex
+{
+public:
+    struct Match
+    {
+        QString text;
+        int score;
+    };
+
+    TrigramIndex();
+
+    void clear();
+    void insert(const QString& text);
+    void remove(const QString& text);
+
+    // matching strings in no particular order, a higher score is a better match
+    QVector<Match> search(const QString& query) const;
+
+    // score of a single string as search() would report it, -1 if it does not match
+    static int match(const QString& query, const QString& text);
+
+private:
+    typedef quint64 Gram;
+
+    QHash<Gram, QVector<int>> postings_;
+    QHash<QString, int> ids_;
+    // removed strings are null until the next compaction
+    QVector<QString> texts_;
+    int removed_;
+    // per string counter of matched query grams, only used during search()
+    mutable QVector<quint16> hits_;
+
+    void compact();
+
+    static QVector<Gram> textGrams(const QString& text);
+    static QVector<Gram> queryGrams(const QString& query);
+    static int score(const QString& query, const QString& text, int hits, int grams);
+};
+
+#endif // TRIGRAMINDEX_H
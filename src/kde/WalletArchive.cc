@@ -0,0 +1,185 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "WalletArchive.h"
+#include "../CipherStream.h"
+
+#include <QDataStream>
+#include <QIODevice>
+#include <QtEndian>
+
+namespace {
+
+const QByteArray MAGIC("PMEX");
+const quint8 VERSION = 2;
+
+// magic, version, salt, nonce and MAC
+const int HEADER_SIZE = 4 + 1 + CipherStream::SALT_LENGTH + CipherStream::NONCE_LENGTH + CipherStream::MAC_LENGTH;
+
+// length and last chunk flag in front of the MAC of every chunk
+const int CHUNK_HEADER_SIZE = sizeof(quint32) + 1;
+
+}
+
+WalletArchive::WalletArchive() :
+    chunk_(0)
+{
+}
+
+WalletArchive::~WalletArchive()
+{
+}
+
+void WalletArchive::create(const QString& passphrase)
+{
+    salt_ = CipherStream::randomBytes(CipherStream::SALT_LENGTH);
+    nonce_ = CipherStream::randomBytes(CipherStream::NONCE_LENGTH);
+
+    QByteArray cipherKey;
+    CipherStream::deriveKeys(passphrase, salt_, cipherKey, macKey_);
+    cipher_.reset(new CipherStream(cipherKey, nonce_));
+    chunk_ = 0;
+}
+
+QByteArray WalletArchive::header() const
+{
+    QByteArray header = MAGIC;
+    header.append(static_cast<char>(VERSION));
+    header.append(salt_);
+    header.append(nonce_);
+    header.append(CipherStream::mac(macKey_, header));
+    return header;
+}
+
+QByteArray WalletArchive::chunk(const QStringList& entries, const QList<WalletContentView>& contents, bool last)
+{
+    QByteArray plainText;
+    QDataStream stream(&plainText, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    stream << static_cast<quint32>(entries.size());
+    for (int i = 0; i < entries.size(); ++i)
+        stream << entries[i] << contents[i];
+
+    const QByteArray cipherText = cipher_->process(plainText);
+
+    QByteArray header(CHUNK_HEADER_SIZE, 0);
+    qToBigEndian<quint32>(cipherText.size(), header.data());
+    header[sizeof(quint32)] = last ? 1 : 0;
+
+    const QByteArray mac = chunkMac(header, cipherText);
+    ++chunk_;
+    return header + mac + cipherText;
+}
+
+bool WalletArchive::open(QIODevice* device, const QString& passphrase)
+{
+    const QByteArray header = device->read(HEADER_SIZE);
+    if (header.size() != HEADER_SIZE || !header.startsWith(MAGIC))
+    {
+        error_ = tr("The file is no password archive");
+        return false;
+    }
+
+    if (quint8(header.at(MAGIC.size())) != VERSION)
+    {
+        error_ = tr("The archive was written by an unsupported version");
+        return false;
+    }
+
+    salt_ = header.mid(MAGIC.size() + 1, CipherStream::SALT_LENGTH);
+    nonce_ = header.mid(MAGIC.size() + 1 + CipherStream::SALT_LENGTH, CipherStream::NONCE_LENGTH);
+
+    QByteArray cipherKey;
+    CipherStream::deriveKeys(passphrase, salt_, cipherKey, macKey_);
+
+    // a wrong passphrase yields a different MAC
+    if (CipherStream::mac(macKey_, header.left(HEADER_SIZE - CipherStream::MAC_LENGTH))
+            != header.right(CipherStream::MAC_LENGTH))
+    {
+        error_ = tr("The passphrase is wrong or the archive is damaged");
+        return false;
+    }
+
+    cipher_.reset(new CipherStream(cipherKey, nonce_));
+    chunk_ = 0;
+    return true;
+}
+
+bool WalletArchive::readChunk(QIODevice* device, QStringList& entries, QList<WalletContentList>& contents, bool& last)
+{
+    entries.clear();
+    contents.clear();
+
+    const QByteArray header = device->read(CHUNK_HEADER_SIZE);
+    const QByteArray mac = device->read(CipherStream::MAC_LENGTH);
+    if (header.size() != CHUNK_HEADER_SIZE || mac.size() != CipherStream::MAC_LENGTH)
+    {
+        error_ = tr("The archive is truncated");
+        return false;
+    }
+
+    // checked before the memory is allocated
+    const quint32 length = qFromBigEndian<quint32>(header.constData());
+    if (!device->isSequential() && length > device->size() - device->pos())
+    {
+        error_ = tr("The archive is truncated");
+        return false;
+    }
+
+    const QByteArray cipherText = device->read(length);
+    if (quint32(cipherText.size()) != length || chunkMac(header, cipherText) != mac)
+    {
+        error_ = tr("The archive is damaged");
+        return false;
+    }
+    ++chunk_;
+
+    const QByteArray plainText = cipher_->process(cipherText);
+    QDataStream stream(plainText);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    quint32 count;
+    stream >> count;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+    {
+        QString entry;
+        WalletContentList content;
+        stream >> entry >> content;
+        entries << entry;
+        contents << content;
+    }
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        error_ = tr("The archive is damaged");
+        return false;
+    }
+
+    last = header.at(sizeof(quint32)) != 0;
+    return true;
+}
+
+QByteArray WalletArchive::chunkMac(const QByteArray& header, const QByteArray& cipherText) const
+{
+    // the chunk number prevents reordering, the flag truncation
+    QByteArray authenticated(sizeof(quint64), 0);
+    qToBigEndian<quint64>(chunk_, authenticated.data());
+    authenticated += header.right(1);
+    authenticated += cipherText;
+    return CipherStream::mac(macKey_, authenticated);
+}
@@ -0,0 +1,67 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WALLETARCHIVE_H
+#define WALLETARCHIVE_H
+
+#include "WalletContent.h"
+#include <QCoreApplication>
+#include <QScopedPointer>
+#include <QStringList>
+
+class CipherStream;
+class QIODevice;
+
+// Password archive (.pmex) written by WalletExporter and restored by
+// WalletImporter.
+//
+// Layout: magic, version, salt, nonce and the MAC of these, followed by
+// chunks of length, last chunk flag, MAC and the encrypted entries. The MAC
+// of a chunk covers its number and the flag, so chunks cannot be reordered
+// and a truncated archive is detected.
+class WalletArchive
+{
+    Q_DECLARE_TR_FUNCTIONS(WalletArchive)
+
+public:
+    WalletArchive();
+    ~WalletArchive();
+
+    // derives the keys of a new archive, takes a while and may run in any thread
+    void create(const QString& passphrase);
+    QByteArray header() const;
+    QByteArray chunk(const QStringList& entries, const QList<WalletContentView>& contents, bool last);
+
+    // reads the header and derives the keys, fails for a wrong passphrase
+    bool open(QIODevice* device, const QString& passphrase);
+    // last is set for the final chunk of the archive
+    bool readChunk(QIODevice* device, QStringList& entries, QList<WalletContentList>& contents, bool& last);
+
+    QString errorString() const { return error_; }
+
+private:
+    QByteArray salt_;
+    QByteArray nonce_;
+    QByteArray macKey_;
+    QScopedPointer<CipherStream> cipher_;
+    quint64 chunk_;
+    QString error_;
+
+    QByteArray chunkMac(const QByteArray& header, const QByteArray& cipherText) const;
+};
+
+#endif // WALLETARCHIVE_H
@@ -0,0 +1,187 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "WalletAudit.h"
+#include "WalletModel.h"
+
+#include <QtConcurrent>
+#include <numeric>
+
+namespace {
+
+// entries read by one wallet request and checked in parallel
+const int BATCH_SIZE = 256;
+
+}
+
+WalletAudit::WalletAudit(WalletModel* model, QObject* parent) :
+    QObject(parent),
+    model_(model),
+    batchLoaded_(false),
+    pos_(0),
+    checkingLast_(false),
+    checkedCount_(0)
+{
+    connect(&loadWatcher_, &QFutureWatcher<QList<WalletContentView>>::finished,
+            this, &WalletAudit::onBatchLoaded);
+    connect(&checkWatcher_, &QFutureWatcher<void>::finished,
+            this, &WalletAudit::onBatchChecked);
+}
+
+WalletAudit::~WalletAudit()
+{
+    wait();
+}
+
+void WalletAudit::start()
+{
+    error_.clear();
+
+    entries_ = model_->entryList();
+    batchLoaded_ = false;
+    pos_ = 0;
+    checkingLast_ = false;
+    checkedCount_ = 0;
+
+    prepare();
+
+    if (entries_.isEmpty())
+    {
+        complete();
+        finish(true);
+    }
+    else
+    {
+        loadNext();
+    }
+}
+
+void WalletAudit::wait()
+{
+    loadWatcher_.waitForFinished();
+    checkWatcher_.waitForFinished();
+}
+
+void WalletAudit::onBatchLoaded()
+{
+    QList<WalletContentView> loaded;
+    if (!missingRows_.isEmpty())
+        loaded = loadWatcher_.result();
+
+    // checks still running use their batch, they finish the audit
+    const bool checking = !checkedEntries_.isEmpty();
+
+    if (loaded.size() < missingRows_.size())
+    {
+        error_ = tr("Entry %1 could not be read").arg(batch_[missingRows_[loaded.size()]]);
+        if (!checking)
+            finish(false);
+        return;
+    }
+
+    for (int i = 0; i < missingRows_.size(); ++i)
+        batchContents_[missingRows_[i]] = loaded[i];
+
+    batchLoaded_ = true;
+    if (!checking)
+        checkBatch();
+}
+
+void WalletAudit::onBatchChecked()
+{
+    if (!checkWatcher_.isFinished())
+        return;
+
+    batchChecked();
+
+    if (!error_.isEmpty())
+    {
+        finish(false);
+    }
+    else if (checkingLast_)
+    {
+        complete();
+        finish(true);
+    }
+    else if (batchLoaded_)
+    {
+        checkBatch();
+    }
+}
+
+void WalletAudit::checkBatch()
+{
+    batchLoaded_ = false;
+    checkedEntries_ = batch_;
+    checkedContents_ = batchContents_;
+    checkedRows_.resize(batch_.size());
+    std::iota(checkedRows_.begin(), checkedRows_.end(), 0);
+
+    // the wallet reads the next batch while this one is checked
+    pos_ += batch_.size();
+    checkingLast_ = pos_ >= entries_.size();
+    if (!checkingLast_)
+        loadNext();
+
+    checkWatcher_.setFuture(QtConcurrent::map(checkedRows_, [this](int row) {
+        check(checkedEntries_.at(row), checkedContents_.at(row));
+    }));
+}
+
+void WalletAudit::loadNext()
+{
+    batch_ = entries_.mid(pos_, BATCH_SIZE);
+    batchContents_.clear();
+    missingRows_.clear();
+
+    QStringList missing;
+    for (int row = 0; row < batch_.size(); ++row)
+    {
+        WalletContentView content;
+        if (!model_->cachedContent(batch_[row], content))
+        {
+            missing << batch_[row];
+            missingRows_ << row;
+        }
+        batchContents_ << content;
+    }
+
+    if (missing.isEmpty())
+        QMetaObject::invokeMethod(this, "onBatchLoaded", Qt::QueuedConnection);
+    else
+        loadWatcher_.setFuture(model_->loadContents(missing));
+}
+
+void WalletAudit::batchChecked()
+{
+    checkedCount_ += checkedEntries_.size();
+    checkedEntries_.clear();
+    checkedContents_.clear();
+
+    emit progress(checkedCount_, entries_.size());
+}
+
+void WalletAudit::finish(bool ok)
+{
+    checkingLast_ = false;
+    batchLoaded_ = false;
+    checkedEntries_.clear();
+    checkedContents_.clear();
+    entries_.clear();
+
+    emit finished(ok);
+}
@@ -0,0 +1,105 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WALLETAUDIT_H
+#define WALLETAUDIT_H
+
+#include "WalletContent.h"
+#include <QFutureWatcher>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+class AuditDialog;
+class WalletModel;
+
+// Checks the credentials of the whole wallet. The entries are read in
+// batches by the wallet worker while the previous batch is checked on the
+// thread pool, one entry per task. Entries cached by the model are not read
+// again.
+//
+// Implementations must call wait() in their destructor, the tasks may still
+// use their members otherwise.
+class WalletAudit : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Credential
+    {
+        QString entry;
+        QString username;
+    };
+
+    WalletAudit(WalletModel* model, QObject* parent = nullptr);
+    virtual ~WalletAudit();
+
+    void start();
+
+    virtual QString title() const = 0;
+    // shows the findings of the entries checked since the last call
+    virtual void reportChecked(AuditDialog* dialog) {}
+    // shows the remaining findings after the audit finished
+    virtual void report(AuditDialog* dialog) const = 0;
+
+    QString errorString() const { return error_; }
+
+signals:
+    void progress(int checked, int total);
+    void finished(bool ok);
+
+protected:
+    // called before the first batch is read
+    virtual void prepare() {}
+    // called on the thread pool, concurrently for the entries of a batch
+    virtual void check(const QString& entry, const WalletContentView& content) = 0;
+    // called after all entries were checked
+    virtual void complete() {}
+
+    void wait();
+
+private slots:
+    void onBatchLoaded();
+    void onBatchChecked();
+
+private:
+    WalletModel* model_;
+    QStringList entries_;
+    // entries of the batch being read, the cached ones are already filled in
+    QStringList batch_;
+    QList<WalletContentView> batchContents_;
+    QVector<int> missingRows_;
+    // the batch was read and waits until the checks of the previous one are done
+    bool batchLoaded_;
+    int pos_;
+    QFutureWatcher<QList<WalletContentView>> loadWatcher_;
+    // entries of the batch being checked
+    QStringList checkedEntries_;
+    QList<WalletContentView> checkedContents_;
+    QVector<int> checkedRows_;
+    bool checkingLast_;
+    int checkedCount_;
+    QFutureWatcher<void> checkWatcher_;
+    QString error_;
+
+    void loadNext();
+    void checkBatch();
+    void batchChecked();
+    void finish(bool ok);
+};
+
+#endif // WALLETAUDIT_H
@@ -0,0 +1,65 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WALLETBACKEND_H
+#define WALLETBACKEND_H
+
+#include <QObject>
+#include <QStringList>
+#include <QByteArray>
+#include <QWidget>
+
+// Storage of the wallet entries. Apart from prepare() all methods are called
+// from the thread of the WalletWorker.
+class WalletBackend : public QObject
+{
+    Q_OBJECT
+
+public:
+    virtual ~WalletBackend() {}
+
+    // called in the GUI thread before open(), may ask the user for input
+    virtual bool prepare(QWidget* window) { return true; }
+
+    virtual bool open(WId window) = 0;
+    virtual bool isOpen() const = 0;
+
+    // the entry names can not be read without the passphrase, they are then
+    // never written to files outside of the wallet
+    virtual bool hidesEntryNames() const { return false; }
+
+    virtual QStringList entryList() = 0;
+    virtual bool readEntry(const QString& key, QByteArray& value) = 0;
+    virtual bool writeEntry(const QString& key, const QByteArray& value) = 0;
+    virtual bool removeEntry(const QString& key) = 0;
+    virtual bool renameEntry(const QString& oldKey, const QString& newKey) = 0;
+
+    // called whenever the request queue ran empty, the writes since the last
+    // call are reported as failed when it returns false
+    virtual bool commit() { return true; }
+    // called when no request arrived for a while
+    virtual void idle() {}
+
+signals:
+    void closed();
+    void folderUpdated(const QString& folder);
+};
+
+// must be overwritten by implementation
+WalletBackend* createWalletBackend();
+
+#endif // WALLETBACKEND_H
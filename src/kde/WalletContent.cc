@@ -16,6 +16,52 @@
  */
 
 #include "WalletContent.h"
+#include <QDataStream>
+
+namespace {
+
+// first byte of the compact format, blobs written with QDataStream start
+// with the high byte of the list size and therefore with 0
+const char COMPACT_MAGIC = char(0xc1);
+const char COMPACT_VERSION = 1;
+
+const char MANIFEST_MAGIC = char(0xc2);
+const char MANIFEST_VERSION = 1;
+
+void writeVarint(QByteArray& out, quint32 value)
+{
+    while (value >= 0x80)
+    {
+        out.append(char(value | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+bool readVarint(const char*& pos, const char* end, quint32& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        if (pos == end)
+            return false;
+
+        quint8 byte = *pos++;
+        value |= quint32(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+void writeString(QByteArray& out, const QString& string)
+{
+    const QByteArray utf8 = string.toUtf8();
+    writeVarint(out, utf8.size());
+    out.append(utf8);
+}
+
+}
 
 WalletContent::WalletContent()
 {
@@ -27,6 +73,11 @@ WalletContent::WalletContent(const QString& username, const QString& password) :
 {
 }
 
+bool WalletContent::operator==(const WalletContent& other) const
+{
+    return username_ == other.username_ && password_ == other.password_;
+}
+
 QDataStream& operator<<(QDataStream& stream, const WalletContent& content)
 {
     stream << content.username_;
@@ -40,3 +91,221 @@ QDataStream& operator>>(QDataStream& stream, WalletContent& content)
     stream >> content.password_;
     return stream;
 }
+
+QByteArray serializeContent(const WalletContentList& content)
+{
+    int size = 2 + 5;
+    for (const WalletContent& c : content)
+        size += 10 + c.username().size() + c.password().size();
+
+    QByteArray rawData;
+    rawData.reserve(size);
+    rawData.append(COMPACT_MAGIC);
+    rawData.append(COMPACT_VERSION);
+
+    writeVarint(rawData, content.size());
+    for (const WalletContent& c : content)
+    {
+        writeString(rawData, c.username());
+        writeString(rawData, c.password());
+    }
+    return rawData;
+}
+
+bool deserializeContent(const QByteArray& rawData, WalletContentList& content)
+{
+    content.clear();
+    if (rawData.isEmpty())
+        return true;
+
+    if (rawData.at(0) == COMPACT_MAGIC)
+    {
+        WalletContentView view;
+        if (!view.parse(rawData))
+            return false;
+        content = view.toList();
+        return true;
+    }
+
+    // written by earlier versions
+    QDataStream stream(rawData);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    stream >> content;
+    return stream.status() == QDataStream::Ok;
+}
+
+WalletContentView::WalletContentView()
+{
+}
+
+WalletContentView::WalletContentView(const WalletContentList& content)
+{
+    parseCompact(serializeContent(content));
+}
+
+bool WalletContentView::parse(const QByteArray& rawData)
+{
+    if (rawData.isEmpty())
+    {
+        *this = WalletContentView();
+        return true;
+    }
+
+    if (rawData.at(0) == COMPACT_MAGIC)
+        return parseCompact(rawData);
+
+    // written by earlier versions
+    WalletContentList content;
+    if (!deserializeContent(rawData, content))
+        return false;
+    return parseCompact(serializeContent(content));
+}
+
+bool WalletContentView::parseCompact(const QByteArray& rawData)
+{
+    const char* begin = rawData.constData();
+    const char* pos = begin + 1;
+    const char* end = begin + rawData.size();
+
+    if (pos == end || *pos++ != COMPACT_VERSION)
+        return false;
+
+    quint32 count;
+    // every credential takes at least two bytes
+    if (!readVarint(pos, end, count) || count > quint32(end - pos) / 2)
+        return false;
+
+    QVector<Field> fields;
+    fields.reserve(2 * count);
+    for (quint32 i = 0; i < 2 * count; ++i)
+    {
+        quint32 length;
+        if (!readVarint(pos, end, length) || quint32(end - pos) < length)
+            return false;
+
+        fields << Field{ 0, int(pos - begin), int(length) };
+        pos += length;
+    }
+
+    if (pos != end)
+        return false;
+
+    blobs_ = QVector<QByteArray>({ rawData });
+    fields_.swap(fields);
+    return true;
+}
+
+WalletContentView WalletContentView::join(const QList<WalletContentView>& views)
+{
+    int count = 0;
+    for (const WalletContentView& view : views)
+        count += view.fields_.size();
+
+    WalletContentView joined;
+    joined.fields_.reserve(count);
+    for (const WalletContentView& view : views)
+    {
+        const int base = joined.blobs_.size();
+        joined.blobs_ += view.blobs_;
+        for (const Field& f : view.fields_)
+            joined.fields_ << Field{ base + f.blob, f.offset, f.length };
+    }
+    return joined;
+}
+
+int WalletContentView::byteSize() const
+{
+    int size = fields_.size() * int(sizeof(Field));
+    for (const QByteArray& blob : blobs_)
+        size += blob.size();
+    return size;
+}
+
+WalletContentList WalletContentView::toList() const
+{
+    WalletContentList content;
+    content.reserve(size());
+    for (int i = 0; i < size(); ++i)
+        content << at(i);
+    return content;
+}
+
+bool WalletContentView::operator==(const WalletContentView& other) const
+{
+    if (fields_.size() != other.fields_.size())
+        return false;
+
+    for (int n = 0; n < fields_.size(); ++n)
+    {
+        if (fieldUtf8(n) != other.fieldUtf8(n))
+            return false;
+    }
+    return true;
+}
+
+QString WalletContentView::field(int n) const
+{
+    const Field& f = fields_.at(n);
+    return QString::fromUtf8(blobs_.at(f.blob).constData() + f.offset, f.length);
+}
+
+QByteArray WalletContentView::fieldUtf8(int n) const
+{
+    const Field& f = fields_.at(n);
+    return QByteArray::fromRawData(blobs_.at(f.blob).constData() + f.offset, f.length);
+}
+
+QDataStream& operator<<(QDataStream& stream, const WalletContentView& content)
+{
+    stream << quint32(content.size());
+    for (int i = 0; i < content.size(); ++i)
+        stream << content.username(i) << content.password(i);
+    return stream;
+}
+
+bool isManifest(const QByteArray& rawData)
+{
+    return !rawData.isEmpty() && rawData.at(0) == MANIFEST_MAGIC;
+}
+
+QByteArray serializeManifest(const WalletManifest& manifest)
+{
+    QByteArray rawData;
+    rawData.reserve(2 + 10 + 5 * manifest.ids.size());
+    rawData.append(MANIFEST_MAGIC);
+    rawData.append(MANIFEST_VERSION);
+
+    writeVarint(rawData, manifest.nextId);
+    writeVarint(rawData, manifest.ids.size());
+    for (quint32 id : manifest.ids)
+        writeVarint(rawData, id);
+    return rawData;
+}
+
+bool deserializeManifest(const QByteArray& rawData, WalletManifest& manifest)
+{
+    if (!isManifest(rawData))
+        return false;
+
+    const char* pos = rawData.constData() + 1;
+    const char* end = rawData.constData() + rawData.size();
+
+    if (pos == end || *pos++ != MANIFEST_VERSION)
+        return false;
+
+    quint32 count;
+    if (!readVarint(pos, end, manifest.nextId) || !readVarint(pos, end, count) || count > quint32(end - pos))
+        return false;
+
+    manifest.ids.clear();
+    manifest.ids.reserve(count);
+    for (quint32 i = 0; i < count; ++i)
+    {
+        quint32 id;
+        if (!readVarint(pos, end, id) || id >= manifest.nextId)
+            return false;
+        manifest.ids << id;
+    }
+    return pos == end;
+}
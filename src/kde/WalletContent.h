@@ -19,8 +19,10 @@
 #define WALLETCONTENT_H
 
 #include <QString>
+#include <QByteArray>
 #include <QMetaType>
 #include <QList>
+#include <QVector>
 
 class WalletContent
 {
@@ -31,6 +33,9 @@ public:
     QString username() const { return username_; }
     QString password() const { return password_; }
 
+    bool operator==(const WalletContent& other) const;
+    bool operator!=(const WalletContent& other) const { return !(*this == other); }
+
     operator QVariant() const { return QVariant(*this); }
 
 private:
@@ -46,7 +51,76 @@ QDataStream& operator>>(QDataStream& stream, WalletContent& content);
 
 typedef QList<WalletContent> WalletContentList;
 
+// Read-only credentials over lists in the compact format. The blobs are shared
+// instead of copied and the strings are only decoded when they are accessed.
+class WalletContentView
+{
+public:
+    WalletContentView();
+    explicit WalletContentView(const WalletContentList& content);
+
+    // accepts both formats, older blobs are converted once
+    bool parse(const QByteArray& rawData);
+    // concatenates the credentials of several views, sharing their blobs
+    static WalletContentView join(const QList<WalletContentView>& views);
+
+    int size() const { return fields_.size() / 2; }
+    bool isEmpty() const { return fields_.isEmpty(); }
+    // bytes kept alive by the view
+    int byteSize() const;
+
+    QString username(int i) const { return field(2 * i); }
+    QString password(int i) const { return field(2 * i + 1); }
+    // UTF-8 of the field without a copy, valid as long as the view exists
+    QByteArray usernameUtf8(int i) const { return fieldUtf8(2 * i); }
+    QByteArray passwordUtf8(int i) const { return fieldUtf8(2 * i + 1); }
+
+    WalletContent at(int i) const { return WalletContent(username(i), password(i)); }
+    WalletContentList toList() const;
+
+    // compares the fields without decoding them
+    bool operator==(const WalletContentView& other) const;
+    bool operator!=(const WalletContentView& other) const { return !(*this == other); }
+
+private:
+    struct Field
+    {
+        int blob;
+        int offset;
+        int length;
+    };
+
+    QVector<QByteArray> blobs_;
+    QVector<Field> fields_;
+
+    bool parseCompact(const QByteArray& rawData);
+    QString field(int n) const;
+    QByteArray fieldUtf8(int n) const;
+};
+
+// same format as streaming the WalletContentList
+QDataStream& operator<<(QDataStream& stream, const WalletContentView& content);
+
+// writes the compact UTF-8 format, reading also accepts the older QDataStream format
+QByteArray serializeContent(const WalletContentList& content);
+bool deserializeContent(const QByteArray& rawData, WalletContentList& content);
+
+// Stored under the entry name when every credential has its own wallet key,
+// lists the ids of the credentials in order
+struct WalletManifest
+{
+    quint32 nextId;
+    QVector<quint32> ids;
+
+    WalletManifest() : nextId(0) {}
+};
+
+bool isManifest(const QByteArray& rawData);
+QByteArray serializeManifest(const WalletManifest& manifest);
+bool deserializeManifest(const QByteArray& rawData, WalletManifest& manifest);
+
 Q_DECLARE_METATYPE(WalletContent);
 Q_DECLARE_METATYPE(WalletContentList);
+Q_DECLARE_METATYPE(WalletContentView);
 
 #endif // WALLETCONTENT_H
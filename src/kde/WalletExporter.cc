@@ -0,0 +1,150 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "WalletExporter.h"
+#include "WalletModel.h"
+
+#include <QSaveFile>
+#include <QtConcurrent>
+
+namespace {
+
+// entries read by one wallet request and encrypted as one chunk
+const int BATCH_SIZE = 256;
+
+}
+
+WalletExporter::WalletExporter(WalletModel* model, QObject* parent) :
+    QObject(parent),
+    model_(model),
+    pos_(0)
+{
+    connect(&keyWatcher_, &QFutureWatcher<void>::finished, this, &WalletExporter::onKeysDerived);
+    connect(&watcher_, &QFutureWatcher<QList<WalletContentView>>::finished,
+            this, &WalletExporter::onBatchLoaded);
+}
+
+WalletExporter::~WalletExporter()
+{
+    keyWatcher_.waitForFinished();
+    watcher_.waitForFinished();
+}
+
+bool WalletExporter::start(const QString& fileName, const QString& passphrase)
+{
+    error_.clear();
+
+    file_.reset(new QSaveFile(fileName));
+    if (!file_->open(QIODevice::WriteOnly))
+    {
+        error_ = file_->errorString();
+        return false;
+    }
+
+    // the key derivation is slow on purpose
+    keyWatcher_.setFuture(QtConcurrent::run([this, passphrase]() {
+        archive_.create(passphrase);
+    }));
+    return true;
+}
+
+void WalletExporter::onKeysDerived()
+{
+    const QByteArray header = archive_.header();
+    if (file_->write(header) != header.size())
+    {
+        error_ = file_->errorString();
+        finish(false);
+        return;
+    }
+
+    entries_ = model_->entryList();
+    pos_ = 0;
+
+    if (entries_.isEmpty())
+        finish(writeChunk(QStringList(), QList<WalletContentView>(), true));
+    else
+        loadNext();
+}
+
+void WalletExporter::onBatchLoaded()
+{
+    // aborted while the batch was read
+    if (!file_)
+        return;
+
+    const QStringList entries = batch_;
+    const QList<WalletContentView> contents = watcher_.result();
+
+    if (contents.size() < entries.size())
+    {
+        error_ = tr("Entry %1 could not be read").arg(entries[contents.size()]);
+        finish(false);
+        return;
+    }
+
+    // the worker reads the next batch while this one is written, one batch
+    // at a time
+    pos_ += entries.size();
+    bool last = pos_ >= entries_.size();
+    if (!last)
+        loadNext();
+
+    if (!writeChunk(entries, contents, last))
+    {
+        finish(false);
+        return;
+    }
+
+    if (last)
+        finish(true);
+}
+
+void WalletExporter::loadNext()
+{
+    batch_ = entries_.mid(pos_, BATCH_SIZE);
+    watcher_.setFuture(model_->loadContents(batch_));
+}
+
+bool WalletExporter::writeChunk(const QStringList& entries, const QList<WalletContentView>& contents, bool last)
+{
+    const QByteArray chunk = archive_.chunk(entries, contents, last);
+    if (file_->write(chunk) != chunk.size())
+    {
+        error_ = file_->errorString();
+        return false;
+    }
+    return true;
+}
+
+void WalletExporter::finish(bool ok)
+{
+    if (ok && !file_->commit())
+    {
+        error_ = file_->errorString();
+        ok = false;
+    }
+    else if (!ok)
+    {
+        file_->cancelWriting();
+    }
+
+    file_.reset();
+    entries_.clear();
+
+    emit finished(ok);
+}
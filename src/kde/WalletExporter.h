@@ -0,0 +1,73 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WALLETEXPORTER_H
+#define WALLETEXPORTER_H
+
+#include "WalletArchive.h"
+#include "WalletContent.h"
+#include <QFutureWatcher>
+#include <QObject>
+#include <QScopedPointer>
+#include <QStringList>
+
+class QSaveFile;
+class WalletModel;
+
+// Writes all entries into one encrypted archive, see WalletArchive. The keys
+// are derived in the thread pool. The entries are read in batches by the
+// wallet worker while the previous batch is encrypted and written, at most
+// two batches are held in memory. The reads are pipelined with the writing,
+// not parallel: they go through the single queue of the worker, as the
+// wallet backends are not thread safe.
+class WalletExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    WalletExporter(WalletModel* model, QObject* parent = nullptr);
+    virtual ~WalletExporter();
+
+    bool start(const QString& fileName, const QString& passphrase);
+
+    QString errorString() const { return error_; }
+
+signals:
+    void finished(bool ok);
+
+private slots:
+    void onKeysDerived();
+    void onBatchLoaded();
+
+private:
+    WalletModel* model_;
+    QStringList entries_;
+    // entries of the batch being read
+    QStringList batch_;
+    int pos_;
+    QFutureWatcher<void> keyWatcher_;
+    QFutureWatcher<QList<WalletContentView>> watcher_;
+    QScopedPointer<QSaveFile> file_;
+    WalletArchive archive_;
+    QString error_;
+
+    void loadNext();
+    bool writeChunk(const QStringList& entries, const QList<WalletContentView>& contents, bool last);
+    void finish(bool ok);
+};
+
+#endif // WALLETEXPORTER_H
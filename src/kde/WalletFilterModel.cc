@@ -0,0 +1,316 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "WalletFilterModel.h"
+#include "WalletModel.h"
+#include "TrigramIndex.h"
+
+WalletFilterModel::WalletFilterModel(WalletModel* model, QObject* parent) :
+    QAbstractProxyModel(parent),
+    model_(model),
+    proxyRowsValid_(false)
+{
+    setSourceModel(model);
+
+    connect(model, &QAbstractItemModel::dataChanged, this, &WalletFilterModel::onSourceDataChanged);
+    connect(model, &QAbstractItemModel::rowsAboutToBeInserted,
+            this, &WalletFilterModel::onSourceRowsAboutToBeInserted);
+    connect(model, &QAbstractItemModel::rowsInserted, this, &WalletFilterModel::onSourceRowsInserted);
+    connect(model, &QAbstractItemModel::rowsAboutToBeRemoved,
+            this, &WalletFilterModel::onSourceRowsAboutToBeRemoved);
+    connect(model, &QAbstractItemModel::rowsRemoved, this, &WalletFilterModel::onSourceRowsRemoved);
+    connect(model, &QAbstractItemModel::rowsAboutToBeMoved,
+            this, &WalletFilterModel::onSourceRowsAboutToBeMoved);
+    connect(model, &QAbstractItemModel::rowsMoved, this, &WalletFilterModel::onSourceRowsMoved);
+    connect(model, &QAbstractItemModel::modelAboutToBeReset,
+            this, &WalletFilterModel::onSourceModelAboutToBeReset);
+    connect(model, &QAbstractItemModel::modelReset, this, &WalletFilterModel::onSourceModelReset);
+}
+
+WalletFilterModel::~WalletFilterModel()
+{
+}
+
+void WalletFilterModel::setFilterText(const QString& text)
+{
+    QString filterText = text.trimmed();
+    if (filterText == filterText_)
+        return;
+
+    // a layout change instead of a reset, the selection and the current index
+    // stay on their entries and only rows filtered out are dropped
+    emit layoutAboutToBeChanged();
+
+    const QModelIndexList proxyIndexes = persistentIndexList();
+    QModelIndexList sourceIndexes;
+    sourceIndexes.reserve(proxyIndexes.size());
+    for (const QModelIndex& proxyIndex : proxyIndexes)
+        sourceIndexes.append(mapToSource(proxyIndex));
+
+    filterText_ = filterText;
+    update();
+
+    QModelIndexList newIndexes;
+    newIndexes.reserve(sourceIndexes.size());
+    for (const QModelIndex& sourceIndex : sourceIndexes)
+        newIndexes.append(mapFromSource(sourceIndex));
+    changePersistentIndexList(proxyIndexes, newIndexes);
+
+    emit layoutChanged();
+}
+
+QModelIndex WalletFilterModel::mapToSource(const QModelIndex& proxyIndex) const
+{
+    if (!proxyIndex.isValid())
+        return QModelIndex();
+
+    int row = isFiltered() ? rows_[proxyIndex.row()] : proxyIndex.row();
+    return model_->index(row, proxyIndex.column());
+}
+
+QModelIndex WalletFilterModel::mapFromSource(const QModelIndex& sourceIndex) const
+{
+    if (!sourceIndex.isValid())
+        return QModelIndex();
+
+    int row = proxyRow(sourceIndex.row());
+    return row < 0 ? QModelIndex() : createIndex(row, sourceIndex.column());
+}
+
+QModelIndex WalletFilterModel::index(int row, int column, const QModelIndex& parent) const
+{
+    if (parent.isValid() || row < 0 || row >= rowCount() || column != 0)
+        return QModelIndex();
+
+    return createIndex(row, column);
+}
+
+QModelIndex WalletFilterModel::parent(const QModelIndex& child) const
+{
+    return QModelIndex();
+}
+
+int WalletFilterModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return isFiltered() ? rows_.size() : model_->rowCount(QModelIndex());
+}
+
+int WalletFilterModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : 1;
+}
+
+void WalletFilterModel::onSourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight,
+                                            const QVector<int>& roles)
+{
+    if (!isFiltered())
+    {
+        emit dataChanged(index(topLeft.row(), 0), index(bottomRight.row(), 0), roles);
+        return;
+    }
+
+    // renamed entries may start or stop matching
+    const bool renamed = roles.isEmpty() || roles.contains(Qt::DisplayRole);
+
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row)
+    {
+        int pr = proxyRow(row);
+        bool matches = pr >= 0;
+        if (renamed)
+        {
+            QString entry = model_->index(row, 0).data(Qt::DisplayRole).toString();
+            matches = TrigramIndex::match(filterText_, entry) >= 0;
+        }
+
+        if (matches && pr >= 0)
+        {
+            emit dataChanged(index(pr, 0), index(pr, 0), roles);
+        }
+        else if (matches)
+        {
+            // appended like inserted rows
+            beginInsertRows(QModelIndex(), rows_.size(), rows_.size());
+            rows_.append(row);
+            proxyRowsValid_ = false;
+            endInsertRows();
+        }
+        else if (pr >= 0)
+        {
+            beginRemoveRows(QModelIndex(), pr, pr);
+            rows_.remove(pr);
+            proxyRowsValid_ = false;
+            endRemoveRows();
+        }
+    }
+}
+
+void WalletFilterModel::onSourceRowsAboutToBeInserted(const QModelIndex& parent, int first, int last)
+{
+    if (!isFiltered())
+        beginInsertRows(QModelIndex(), first, last);
+}
+
+void WalletFilterModel::onSourceRowsInserted(const QModelIndex& parent, int first, int last)
+{
+    if (!isFiltered())
+    {
+        endInsertRows();
+        return;
+    }
+
+    const int count = last - first + 1;
+    for (int& row : rows_)
+    {
+        if (row >= first)
+            row += count;
+    }
+    proxyRowsValid_ = false;
+
+    // new matches are appended, the order is fixed up by the next search
+    QVector<int> added;
+    for (int row = first; row <= last; ++row)
+    {
+        QString entry = model_->index(row, 0).data(Qt::DisplayRole).toString();
+        if (TrigramIndex::match(filterText_, entry) >= 0)
+            added.append(row);
+    }
+
+    if (added.isEmpty())
+        return;
+
+    beginInsertRows(QModelIndex(), rows_.size(), rows_.size() + added.size() - 1);
+    rows_ += added;
+    endInsertRows();
+}
+
+void WalletFilterModel::onSourceRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last)
+{
+    if (!isFiltered())
+    {
+        beginRemoveRows(QModelIndex(), first, last);
+        return;
+    }
+
+    auto removed = [first, last](int row) { return row >= first && row <= last; };
+
+    // remove runs of adjacent proxy rows at once, from the end to keep the positions valid
+    for (int i = rows_.size() - 1; i >= 0; --i)
+    {
+        if (!removed(rows_[i]))
+            continue;
+
+        int j = i;
+        while (j > 0 && removed(rows_[j - 1]))
+            --j;
+
+        beginRemoveRows(QModelIndex(), j, i);
+        rows_.remove(j, i - j + 1);
+        proxyRowsValid_ = false;
+        endRemoveRows();
+
+        i = j;
+    }
+}
+
+void WalletFilterModel::onSourceRowsRemoved(const QModelIndex& parent, int first, int last)
+{
+    if (!isFiltered())
+    {
+        endRemoveRows();
+        return;
+    }
+
+    const int count = last - first + 1;
+    for (int& row : rows_)
+    {
+        if (row > last)
+            row -= count;
+    }
+    proxyRowsValid_ = false;
+}
+
+void WalletFilterModel::onSourceRowsAboutToBeMoved(const QModelIndex& sourceParent, int sourceStart,
+                                                   int sourceEnd, const QModelIndex& destinationParent,
+                                                   int destinationRow)
+{
+    if (!isFiltered())
+        beginMoveRows(QModelIndex(), sourceStart, sourceEnd, QModelIndex(), destinationRow);
+}
+
+void WalletFilterModel::onSourceRowsMoved(const QModelIndex& parent, int start, int end,
+                                          const QModelIndex& destination, int row)
+{
+    if (!isFiltered())
+    {
+        endMoveRows();
+        return;
+    }
+
+    // the matches keep their position, only the source rows change
+    const int count = end - start + 1;
+    for (int& r : rows_)
+    {
+        if (r >= start && r <= end)
+            r += row > end ? row - end - 1 : row - start;
+        else if (row > end && r > end && r < row)
+            r -= count;
+        else if (row < start && r >= row && r < start)
+            r += count;
+    }
+    proxyRowsValid_ = false;
+}
+
+void WalletFilterModel::onSourceModelAboutToBeReset()
+{
+    beginResetModel();
+}
+
+void WalletFilterModel::onSourceModelReset()
+{
+    update();
+    endResetModel();
+}
+
+void WalletFilterModel::update()
+{
+    rows_.clear();
+    proxyRows_.clear();
+    proxyRowsValid_ = false;
+
+    if (isFiltered())
+        rows_ = model_->search(filterText_);
+}
+
+int WalletFilterModel::proxyRow(int sourceRow) const
+{
+    if (!isFiltered())
+        return sourceRow;
+
+    if (!proxyRowsValid_)
+    {
+        proxyRows_.clear();
+        proxyRows_.reserve(rows_.size());
+        for (int i = 0; i < rows_.size(); ++i)
+            proxyRows_.insert(rows_[i], i);
+        proxyRowsValid_ = true;
+    }
+
+    return proxyRows_.value(sourceRow, -1);
+}
@@ -0,0 +1,76 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WALLETFILTERMODEL_H
+#define WALLETFILTERMODEL_H
+
+#include <QAbstractProxyModel>
+#include <QHash>
+#include <QVector>
+
+class WalletModel;
+
+// Shows the entries of a WalletModel matching a search text, best matches
+// first. Without a search text all rows are passed through unchanged.
+class WalletFilterModel : public QAbstractProxyModel
+{
+    Q_OBJECT
+
+public:
+    WalletFilterModel(WalletModel* model, QObject* parent = nullptr);
+    virtual ~WalletFilterModel();
+
+    QString filterText() const { return filterText_; }
+    void setFilterText(const QString& text);
+
+    QModelIndex mapToSource(const QModelIndex& proxyIndex) const override;
+    QModelIndex mapFromSource(const QModelIndex& sourceIndex) const override;
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+
+private slots:
+    void onSourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight,
+                             const QVector<int>& roles);
+    void onSourceRowsAboutToBeInserted(const QModelIndex& parent, int first, int last);
+    void onSourceRowsInserted(const QModelIndex& parent, int first, int last);
+    void onSourceRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last);
+    void onSourceRowsRemoved(const QModelIndex& parent, int first, int last);
+    void onSourceRowsAboutToBeMoved(const QModelIndex& sourceParent, int sourceStart, int sourceEnd,
+                                    const QModelIndex& destinationParent, int destinationRow);
+    void onSourceRowsMoved(const QModelIndex& parent, int start, int end,
+                           const QModelIndex& destination, int row);
+    void onSourceModelAboutToBeReset();
+    void onSourceModelReset();
+
+private:
+    WalletModel* model_;
+    QString filterText_;
+    // source rows of the matching entries, only used with a search text
+    QVector<int> rows_;
+    // proxy row of every source row in rows_, rebuilt on demand
+    mutable QHash<int, int> proxyRows_;
+    mutable bool proxyRowsValid_;
+
+    bool isFiltered() const { return !filterText_.isEmpty(); }
+    void update();
+    int proxyRow(int sourceRow) const;
+};
+
+#endif // WALLETFILTERMODEL_H
@@ -0,0 +1,435 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "WalletImporter.h"
+#include "WalletArchive.h"
+#include "WalletModel.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QUrl>
+#include <QXmlStreamReader>
+#include <QtConcurrent>
+
+namespace {
+
+// entries handed to the GUI thread at once
+const int BATCH_SIZE = 1000;
+
+// the parser waits while this many entries are not added to the model yet
+const int MAX_PARSED = 4 * BATCH_SIZE;
+
+// characters read from the input at once
+const int CHUNK_SIZE = 64 * 1024;
+
+// column names used by common exports, the first match wins
+const char* const NAME_COLUMNS[] = { "title", "name", "account" };
+const char* const URL_COLUMNS[] = { "url", "login_uri", "web site", "website" };
+const char* const USERNAME_COLUMNS[] = { "username", "login_username", "login name", "user", "login" };
+const char* const PASSWORD_COLUMNS[] = { "password", "login_password" };
+
+// CSV as described in RFC 4180, fields may contain quoted line breaks
+class CsvReader
+{
+public:
+    CsvReader(QIODevice* device) :
+        stream_(device),
+        pos_(0)
+    {
+        stream_.setCodec("UTF-8");
+    }
+
+    bool readRow(QStringList& row)
+    {
+        row.clear();
+
+        QString field;
+        bool quoted = false;
+        bool any = false;
+        QChar c;
+
+        while (next(c))
+        {
+            any = true;
+
+            if (quoted)
+            {
+                if (c != '"')
+                {
+                    field += c;
+                }
+                else if (peek() == '"')
+                {
+                    // escaped quote
+                    next(c);
+                    field += c;
+                }
+                else
+                {
+                    quoted = false;
+                }
+            }
+            else if (c == '"')
+            {
+                quoted = true;
+            }
+            else if (c == ',')
+            {
+                row << field;
+                field.clear();
+            }
+            else if (c == '\n')
+            {
+                row << field;
+                return true;
+            }
+            else if (c != '\r')
+            {
+                field += c;
+            }
+        }
+
+        if (any)
+            row << field;
+        return any;
+    }
+
+private:
+    QTextStream stream_;
+    QString buffer_;
+    int pos_;
+
+    bool fill()
+    {
+        if (pos_ < buffer_.size())
+            return true;
+
+        buffer_ = stream_.read(CHUNK_SIZE);
+        pos_ = 0;
+        return !buffer_.isEmpty();
+    }
+
+    bool next(QChar& c)
+    {
+        if (!fill())
+            return false;
+        c = buffer_[pos_++];
+        return true;
+    }
+
+    QChar peek()
+    {
+        return fill() ? buffer_[pos_] : QChar();
+    }
+};
+
+template<int N>
+int findColumn(const QStringList& header, const char* const (&names)[N])
+{
+    for (const char* name : names)
+    {
+        for (int i = 0; i < header.size(); ++i)
+        {
+            if (header[i].trimmed().compare(QLatin1String(name), Qt::CaseInsensitive) == 0)
+                return i;
+        }
+    }
+    return -1;
+}
+
+// web addresses are shortened to the host name
+QString entryName(const QString& name, const QString& url)
+{
+    if (!name.trimmed().isEmpty())
+        return name.trimmed();
+
+    QUrl u = QUrl::fromUserInput(url.trimmed());
+    return u.host().isEmpty() ? url.trimmed() : u.host();
+}
+
+}
+
+WalletImporter::WalletImporter(WalletModel* model, QObject* parent) :
+    QObject(parent),
+    model_(model),
+    batchOpen_(false),
+    count_(0)
+{
+    connect(this, &WalletImporter::batchParsed, this, &WalletImporter::onBatchParsed, Qt::QueuedConnection);
+    connect(&watcher_, &QFutureWatcher<bool>::finished, this, &WalletImporter::onParseFinished);
+}
+
+WalletImporter::~WalletImporter()
+{
+    {
+        QMutexLocker locker(&mutex_);
+        canceled_.store(1);
+        drained_.wakeAll();
+    }
+    watcher_.waitForFinished();
+
+    // the credentials added so far are kept, the model may be gone already
+    // when the widget is destroyed
+    if (batchOpen_ && model_)
+        model_->commitBatch();
+}
+
+WalletImporter::Format WalletImporter::formatOf(const QString& fileName)
+{
+    const QString suffix = QFileInfo(fileName).suffix();
+    if (suffix.compare("pmex", Qt::CaseInsensitive) == 0)
+        return Archive;
+    return suffix.compare("xml", Qt::CaseInsensitive) == 0 ? KeePassXml : Csv;
+}
+
+void WalletImporter::start(const QString& fileName, Format format, const QString& passphrase)
+{
+    count_ = 0;
+    error_.clear();
+    canceled_.store(0);
+
+    model_->beginBatch();
+    batchOpen_ = true;
+
+    watcher_.setFuture(QtConcurrent::run(this, &WalletImporter::parse, fileName, format, passphrase));
+}
+
+void WalletImporter::onBatchParsed()
+{
+    QList<ParsedEntry> batch;
+    {
+        QMutexLocker locker(&mutex_);
+        batch.swap(parsed_);
+        drained_.wakeAll();
+    }
+
+    if (!model_)
+        return;
+
+    // collected by the batch opened in start()
+    for (const ParsedEntry& parsed : batch)
+    {
+        // names the wallet can not store are skipped
+        if (!WalletModel::isValidEntry(parsed.entry))
+            continue;
+
+        if (parsed.replace)
+        {
+            model_->replaceEntry(parsed.entry, parsed.content);
+        }
+        else
+        {
+            for (const WalletContent& credential : parsed.content)
+                model_->addPassword(parsed.entry, credential.username(), credential.password());
+        }
+        count_ += parsed.content.size();
+    }
+}
+
+void WalletImporter::onParseFinished()
+{
+    // the last batch may still be queued
+    onBatchParsed();
+
+    if (batchOpen_ && model_)
+        model_->commitBatch();
+    batchOpen_ = false;
+
+    emit finished(watcher_.result());
+}
+
+bool WalletImporter::parse(const QString& fileName, Format format, const QString& passphrase)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        error_ = file.errorString();
+        return false;
+    }
+
+    bool ok;
+    switch (format)
+    {
+    case KeePassXml:
+        ok = parseKeePassXml(&file);
+        break;
+    case Archive:
+        ok = parseArchive(&file, passphrase);
+        break;
+    default:
+        ok = parseCsv(&file);
+        break;
+    }
+
+    post();
+    return ok;
+}
+
+bool WalletImporter::parseCsv(QIODevice* device)
+{
+    CsvReader reader(device);
+
+    QStringList row;
+    if (!reader.readRow(row))
+    {
+        error_ = tr("The file is empty");
+        return false;
+    }
+
+    const int nameColumn = findColumn(row, NAME_COLUMNS);
+    const int urlColumn = findColumn(row, URL_COLUMNS);
+    const int usernameColumn = findColumn(row, USERNAME_COLUMNS);
+    const int passwordColumn = findColumn(row, PASSWORD_COLUMNS);
+    if ((nameColumn < 0 && urlColumn < 0) || passwordColumn < 0)
+    {
+        error_ = tr("The file has no name or password column");
+        return false;
+    }
+
+    auto field = [&row](int column) { return column >= 0 && column < row.size() ? row[column] : QString(); };
+
+    while (reader.readRow(row) && !canceled_.load())
+        add(entryName(field(nameColumn), field(urlColumn)), field(usernameColumn), field(passwordColumn));
+
+    return true;
+}
+
+bool WalletImporter::parseKeePassXml(QIODevice* device)
+{
+    QXmlStreamReader xml(device);
+
+    bool inEntry = false;
+    QString key;
+    QString title, url, username, password;
+
+    while (!xml.atEnd() && !canceled_.load())
+    {
+        xml.readNext();
+
+        if (xml.isStartElement())
+        {
+            if (xml.name() == QLatin1String("History"))
+            {
+                // earlier versions of the entry
+                xml.skipCurrentElement();
+            }
+            else if (xml.name() == QLatin1String("Entry"))
+            {
+                inEntry = true;
+                title.clear();
+                url.clear();
+                username.clear();
+                password.clear();
+            }
+            else if (inEntry && xml.name() == QLatin1String("Key"))
+            {
+                key = xml.readElementText();
+            }
+            else if (inEntry && xml.name() == QLatin1String("Value"))
+            {
+                QString value = xml.readElementText();
+                if (key == QLatin1String("Title"))
+                    title = value;
+                else if (key == QLatin1String("URL"))
+                    url = value;
+                else if (key == QLatin1String("UserName"))
+                    username = value;
+                else if (key == QLatin1String("Password"))
+                    password = value;
+            }
+        }
+        else if (xml.isEndElement() && xml.name() == QLatin1String("Entry"))
+        {
+            inEntry = false;
+            add(entryName(title, url), username, password);
+        }
+    }
+
+    if (xml.hasError())
+    {
+        error_ = tr("Line %1: %2").arg(xml.lineNumber()).arg(xml.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool WalletImporter::parseArchive(QIODevice* device, const QString& passphrase)
+{
+    WalletArchive archive;
+    if (!archive.open(device, passphrase))
+    {
+        error_ = archive.errorString();
+        return false;
+    }
+
+    QStringList entries;
+    QList<WalletContentList> contents;
+    bool last = false;
+
+    while (!last && !canceled_.load())
+    {
+        if (!archive.readChunk(device, entries, contents, last))
+        {
+            error_ = archive.errorString();
+            return false;
+        }
+
+        for (int i = 0; i < entries.size(); ++i)
+            restore(entries[i], contents[i]);
+    }
+    return true;
+}
+
+void WalletImporter::add(const QString& entry, const QString& username, const QString& password)
+{
+    if (entry.isEmpty() || (username.isEmpty() && password.isEmpty()))
+        return;
+
+    parsing_.append(ParsedEntry{ entry, WalletContentList() << WalletContent(username, password), false });
+    if (parsing_.size() >= BATCH_SIZE)
+        post();
+}
+
+void WalletImporter::restore(const QString& entry, const WalletContentList& content)
+{
+    if (entry.isEmpty())
+        return;
+
+    // the archive holds every entry once, with all its credentials
+    parsing_.append(ParsedEntry{ entry, content, true });
+    if (parsing_.size() >= BATCH_SIZE)
+        post();
+}
+
+void WalletImporter::post()
+{
+    if (parsing_.isEmpty())
+        return;
+
+    {
+        QMutexLocker locker(&mutex_);
+        while (parsed_.size() >= MAX_PARSED && !canceled_.load())
+            drained_.wait(&mutex_);
+        parsed_ += parsing_;
+    }
+    parsing_.clear();
+
+    // the model is only changed in the GUI thread
+    emit batchParsed();
+}
@@ -0,0 +1,111 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WALLETIMPORTER_H
+#define WALLETIMPORTER_H
+
+#include "WalletContent.h"
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QWaitCondition>
+
+class QIODevice;
+class WalletModel;
+
+// Reads the credentials exported by other password managers and restores
+// the archives written by WalletExporter. The file is parsed in the thread
+// pool, the parser waits while the GUI thread is behind. All credentials go
+// into one batch of the model, the rows appear and every entry is written
+// once the file is read. Restored entries replace the stored credentials,
+// imported ones are appended.
+class WalletImporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Format
+    {
+        Csv,
+        KeePassXml,
+        Archive,
+    };
+
+    WalletImporter(WalletModel* model, QObject* parent = nullptr);
+    virtual ~WalletImporter();
+
+    static Format formatOf(const QString& fileName);
+
+    // finished() is emitted once the file is read, the credentials read
+    // before an error are kept. The passphrase is only used by archives.
+    void start(const QString& fileName, Format format, const QString& passphrase = QString());
+
+    int importedCount() const { return count_; }
+    QString errorString() const { return error_; }
+
+signals:
+    void finished(bool ok);
+
+    // internal, a batch was parsed
+    void batchParsed();
+
+private slots:
+    void onBatchParsed();
+    void onParseFinished();
+
+private:
+    // credentials of one entry found in the file
+    struct ParsedEntry
+    {
+        QString entry;
+        WalletContentList content;
+        // the content replaces the stored credentials of the entry
+        bool replace;
+    };
+
+    QPointer<WalletModel> model_;
+    // the batch of the model is open until the parser finished
+    bool batchOpen_;
+    int count_;
+    // written by the parser, read once it finished
+    QString error_;
+    QFutureWatcher<bool> watcher_;
+    // set to stop the parser
+    QAtomicInt canceled_;
+    // entries of the batch being parsed, only used by the parser
+    QList<ParsedEntry> parsing_;
+    QMutex mutex_;
+    // parsed batches not yet added to the model, limited in size
+    QList<ParsedEntry> parsed_;
+    // wakes the parser when parsed_ was taken
+    QWaitCondition drained_;
+
+    // run in the thread pool
+    bool parse(const QString& fileName, Format format, const QString& passphrase);
+    bool parseCsv(QIODevice* device);
+    bool parseKeePassXml(QIODevice* device);
+    bool parseArchive(QIODevice* device, const QString& passphrase);
+    void add(const QString& entry, const QString& username, const QString& password);
+    void restore(const QString& entry, const WalletContentList& content);
+    void post();
+};
+
+#endif // WALLETIMPORTER_H
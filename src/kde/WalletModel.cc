@@ -16,42 +16,121 @@
  */
 
 #include "WalletModel.h"
+#include "WalletWorker.h"
 #include "../main.h"
 #include "../MainFrame.h"
 #include "../StatusBubble.h"
-#include <kwallet.h>
+#include <QSettings>
+#include <QtConcurrent>
 #include <QWidget>
 #include <QDebug>
 #include <algorithm>
+#include <limits>
+#include <numeric>
 
 namespace {
 
-int compare(const QString& a, const QString&b)
+// upper bound for the cached entry contents in bytes
+const int CONTENT_CACHE_SIZE = 4 * 1024 * 1024;
+
+// number of changed rows above which load() resets the model
+const int RESET_THRESHOLD = 1000;
+
+// time in ms to wait for further folderUpdated notifications before reloading
+const int FOLDER_UPDATE_DELAY = 100;
+
+// shows the entry names of the last session while the wallet opens, off by default
+const char* SNAPSHOT_SETTING = "wallet/entrySnapshot";
+
+int compare(const QCollatorSortKey& aKey, const QString& a, const QCollatorSortKey& bKey, const QString& b)
+{
+    // different names may collate equal, their code points keep the order strict
+    int cmp = aKey.compare(bKey);
+    return cmp != 0 ? cmp : a.compare(b);
+}
+
+int contentCost(const WalletContentView& content)
 {
-    return a.compare(b);
+    return sizeof(WalletContentView) + content.byteSize();
 }
 
 }
 
 WalletModel::WalletModel(QWidget* parent) :
     QAbstractListModel(parent),
-    wallet_(nullptr)
+    worker_(new WalletWorker(this)),
+    walletOpen_(false),
+    walletOpening_(false),
+    entryRowsValid_(std::numeric_limits<int>::max()),
+    walletContents_(CONTENT_CACHE_SIZE),
+    searchIndexValid_(false),
+    searchIndexBuilding_(false),
+    searchIndexStale_(false),
+    externalUpdate_(false),
+    snapshotShown_(false),
+    batchDepth_(0)
 {
+    folderUpdateTimer_.setSingleShot(true);
+    folderUpdateTimer_.setInterval(FOLDER_UPDATE_DELAY);
+    connect(&folderUpdateTimer_, &QTimer::timeout, this, &WalletModel::onFolderUpdateTimeout);
+    connect(&searchIndexWatcher_, &QFutureWatcher<TrigramIndex>::finished, this, &WalletModel::onSearchIndexBuilt);
+
+    connect(worker_, &WalletWorker::walletOpened, this, &WalletModel::onWalletOpened);
+    connect(worker_, &WalletWorker::walletClosed, this, &WalletModel::onWalletClosed);
+    connect(worker_, &WalletWorker::folderUpdated, this, &WalletModel::onFolderUpdated);
+    connect(worker_, &WalletWorker::entryListLoaded, this, &WalletModel::onEntryListLoaded);
+    connect(worker_, &WalletWorker::contentLoaded, this, &WalletModel::onContentLoaded);
+    connect(worker_, &WalletWorker::writeFinished, this, &WalletModel::onWriteFinished);
+    connect(&usage_, &EntryUsage::changed, this, &WalletModel::recentEntriesChanged);
+
+    // the files hold the entry names in plain text, the local wallet keeps
+    // them encrypted and does not get them
+    const bool namesHidden = worker_->hidesEntryNames();
+    snapshot_.setEnabled(!namesHidden && QSettings().value(SNAPSHOT_SETTING, false).toBool());
+    usage_.setPersistent(!namesHidden);
 }
 
 WalletModel::~WalletModel()
 {
-    if (wallet_)
-        delete wallet_;
 }
 
 void WalletModel::openWallet()
 {
+    // opening may take seconds, the names of the last session are merged
+    // with the wallet listing once it is loaded
+    if (!walletOpen_ && folderEntries_.isEmpty())
+    {
+        QStringList entries = snapshot_.load();
+        if (!entries.isEmpty())
+        {
+            // sorted again, the locale may have changed since
+            SortKeys keys;
+            sortEntries(entries, keys);
+            reset(entries, keys);
+            snapshotShown_ = true;
+        }
+    }
+
     ensureOpenWallet();
 }
 
 QModelIndex WalletModel::addEntry(const QString& entry)
 {
+    if (!isValidEntry(entry))
+        return QModelIndex();
+
+    if (batchDepth_ > 0)
+    {
+        BatchEntry& change = batch_[entry];
+        if (change.removed)
+        {
+            // removed and added again, the entry starts out empty
+            change.removed = false;
+            change.replace = true;
+        }
+        return find(entry);
+    }
+
     QModelIndex idx = find(entry);
     if (!idx.isValid())
     {
@@ -64,21 +143,188 @@ QModelIndex WalletModel::addEntry(const QString& entry)
 
 QModelIndex WalletModel::addPassword(const QString& entry, const QString& username, const QString& password)
 {
+    if (!isValidEntry(entry))
+        return QModelIndex();
+
     QModelIndex idx = addEntry(entry);
 
-    WalletContentList content = loadEntryContent(entry);
-    content << WalletContent(username, password);
-    saveEntryContent(entry, content);
+    if (batchDepth_ > 0)
+    {
+        batch_[entry].content << WalletContent(username, password);
+        return idx;
+    }
+
+    WalletContentView* cached = walletContents_.object(entry);
+    if (cached)
+    {
+        WalletContentList content = cached->toList();
+        content << WalletContent(username, password);
+        saveEntryContent(entry, content);
+    }
+    else
+    {
+        // appended to the stored credentials without reading them
+        beginWrite(entry);
+        worker_->appendContent(entry, WalletContentList() << WalletContent(username, password));
+    }
 
     return idx;
 }
 
+QModelIndex WalletModel::replaceEntry(const QString& entry, const WalletContentList& content)
+{
+    if (!isValidEntry(entry))
+        return QModelIndex();
+
+    // a batch of its own outside of one, the entry is written once
+    beginBatch();
+    BatchEntry& change = batch_[entry];
+    change.removed = false;
+    change.replace = true;
+    change.content = content;
+    commitBatch();
+
+    return find(entry);
+}
+
+bool WalletModel::isValidEntry(const QString& entry)
+{
+    // the wallet keys of the credentials are made of the entry name and a separator
+    return WalletWorker::isValidEntry(entry);
+}
+
+void WalletModel::beginBatch()
+{
+    ++batchDepth_;
+}
+
+void WalletModel::commitBatch()
+{
+    static auto contentRoles = QVector<int>({WalletContentRole});
+
+    if (batchDepth_ == 0 || --batchDepth_ > 0)
+        return;
+
+    QHash<QString, BatchEntry> batch;
+    batch.swap(batch_);
+
+    QStringList newEntries;
+    QSet<QString> removed;
+    for (auto it = batch.constBegin(); it != batch.constEnd(); ++it)
+    {
+        const bool exists = find(it.key()).isValid();
+        if (it->removed && exists)
+            removed.insert(it.key());
+        else if (!it->removed && !exists)
+            newEntries << it.key();
+    }
+
+    // all rows are changed with a single merge instead of one call per entry
+    if (!newEntries.isEmpty() || !removed.isEmpty())
+    {
+        SortKeys newKeys;
+        sortEntries(newEntries, newKeys);
+
+        QStringList entries;
+        SortKeys keys;
+        entries.reserve(folderEntries_.size() + newEntries.size());
+        keys.reserve(folderEntries_.size() + newEntries.size());
+
+        int row = 0;
+        int i = 0;
+        while (row < folderEntries_.size() || i < newEntries.size())
+        {
+            if (row < folderEntries_.size() && removed.contains(folderEntries_[row]))
+            {
+                ++row;
+            }
+            else if (row >= folderEntries_.size() || (i < newEntries.size()
+                    && compare(newKeys[i], newEntries[i], sortKeys_[row], folderEntries_[row]) < 0))
+            {
+                entries << newEntries[i];
+                keys.push_back(newKeys[i++]);
+            }
+            else
+            {
+                entries << folderEntries_[row];
+                keys.push_back(sortKeys_[row++]);
+            }
+        }
+        applyEntries(entries, keys);
+    }
+
+    for (const QString& entry : removed)
+        walletRemove(entry);
+
+    // the writes are queued in one go, the backend commits them together
+    const QSet<QString> created = QSet<QString>::fromList(newEntries);
+    int firstChanged = std::numeric_limits<int>::max();
+    int lastChanged = -1;
+    for (auto it = batch.constBegin(); it != batch.constEnd(); ++it)
+    {
+        const QString& entry = it.key();
+        if (it->removed)
+            continue;
+
+        if (created.contains(entry) || it->replace)
+        {
+            saveEntryContent(entry, it->content);
+        }
+        else if (it->content.isEmpty())
+        {
+            continue;
+        }
+        else if (WalletContentView* cached = walletContents_.object(entry))
+        {
+            saveEntryContent(entry, cached->toList() + it->content);
+        }
+        else
+        {
+            // appended to the stored credentials without reading them
+            beginWrite(entry);
+            worker_->appendContent(entry, it->content);
+        }
+
+        if (!created.contains(entry))
+        {
+            const int row = find(entry).row();
+            firstChanged = qMin(firstChanged, row);
+            lastChanged = qMax(lastChanged, row);
+        }
+    }
+
+    if (lastChanged >= 0)
+        emit dataChanged(index(firstChanged), index(lastChanged), contentRoles);
+}
+
 QStringList WalletModel::entryList() const
 {
     // return copy
     return folderEntries_;
 }
 
+void WalletModel::markUsed(const QModelIndex& index)
+{
+    if (index.isValid())
+        usage_.use(folderEntries_[index.row()]);
+}
+
+QStringList WalletModel::recentEntries(int count) const
+{
+    QStringList entries;
+    for (const QString& entry : usage_.ranked())
+    {
+        // removed by another client or not loaded yet
+        if (!entryRows_.contains(entry))
+            continue;
+
+        entries << entry;
+        if (entries.size() == count)
+            break;
+    }
+    return entries;
+}
+
 bool WalletModel::hasEntry(const QString& entry) const
 {
     QModelIndex idx = find(entry);
@@ -91,18 +337,96 @@ void WalletModel::removeEntry(const QModelIndex& index)
         return;
 
     const QString entry = folderEntries_[index.row()];
-    if (walletRemove(entry))
-        remove(index);
+    if (batchDepth_ > 0)
+    {
+        batch_[entry] = BatchEntry();
+        batch_[entry].removed = true;
+        return;
+    }
+
+    walletRemove(entry);
+    remove(index);
 }
 
 void WalletModel::removeEntry(const QString& entry)
 {
+    if (batchDepth_ > 0)
+    {
+        // may also drop an entry added earlier in the batch
+        batch_[entry] = BatchEntry();
+        batch_[entry].removed = true;
+        return;
+    }
+
     QModelIndex idx = find(entry);
     if (!idx.isValid())
         return;
 
-    if (walletRemove(entry))
-        remove(idx);
+    walletRemove(entry);
+    remove(idx);
+}
+
+void WalletModel::prefetch(int first, int last)
+{
+    first = qMax(0, first);
+    last = qMin(last, folderEntries_.size() - 1);
+
+    for (int row = first; row <= last; ++row)
+        requestEntryContent(folderEntries_[row]);
+}
+
+QFuture<QList<WalletContentView>> WalletModel::loadContents(const QStringList& entries) const
+{
+    return worker_->loadContents(entries);
+}
+
+bool WalletModel::cachedContent(const QString& entry, WalletContentView& content) const
+{
+    WalletContentView* cached = walletContents_.object(entry);
+    if (!cached)
+        return false;
+
+    // edits are cached when they are saved, it is never older than the wallet
+    content = *cached;
+    return true;
+}
+
+QVector<int> WalletModel::search(const QString& text)
+{
+    if (!searchIndexValid_)
+    {
+        // searched before the build finished, or before the wallet was loaded
+        if (searchIndexBuilding_ && !searchIndexStale_)
+        {
+            searchIndexWatcher_.waitForFinished();
+            onSearchIndexBuilt();
+        }
+        else
+        {
+            searchIndex_.clear();
+            for (const QString& entry : folderEntries_)
+                searchIndex_.insert(entry);
+            searchIndexEdits_.clear();
+            searchIndexValid_ = true;
+        }
+    }
+
+    QVector<TrigramIndex::Match> matches = searchIndex_.search(text);
+
+    // best score first, equal scores in list order, the rows are looked up
+    // after one index update
+    updateIndex();
+    QVector<QPair<int, int>> ranked;
+    ranked.reserve(matches.size());
+    for (const TrigramIndex::Match& match : matches)
+        ranked.append(qMakePair(-match.score, entryRows_.value(match.text)));
+    std::sort(ranked.begin(), ranked.end());
+
+    QVector<int> rows;
+    rows.reserve(ranked.size());
+    for (const auto& r : ranked)
+        rows.append(r.second);
+    return rows;
 }
 
 Qt::ItemFlags WalletModel::flags(const QModelIndex& index) const
@@ -126,8 +450,11 @@ QVariant WalletModel::data(const QModelIndex& index, int role) const
 
     if (role == WalletContentRole)
     {
+        // an invalid value is returned until the content is loaded
         const QString& entry = folderEntries_[index.row()];
-        return QVariant::fromValue(loadEntryContent(entry));
+        WalletContentView content;
+        if (loadEntryContent(entry, content))
+            return QVariant::fromValue(content);
     }
 
     return QVariant();
@@ -143,22 +470,34 @@ bool WalletModel::setData(const QModelIndex& index, const QVariant& value, int r
 
     if (role == Qt::DisplayRole || role == Qt::EditRole)
     {
-        QString& oldValue = folderEntries_[index.row()];
+        const QString oldValue = folderEntries_[index.row()];
         QString newValue = value.toString();
-        if (!newValue.isEmpty() && newValue != oldValue)
+        if (!newValue.isEmpty() && newValue != oldValue && isValidEntry(newValue)
+                && !hasEntry(newValue) && !batch_.contains(newValue))
         {
-            if (walletRename(oldValue, newValue))
-            {
-                rename(index, newValue);
-                emit dataChanged(index, index, entryRoles);
-                return true;
-            }
+            walletRename(oldValue, newValue);
+            QModelIndex newIndex = rename(index, newValue);
+            emit dataChanged(newIndex, newIndex, entryRoles);
+
+            // the collected changes follow the entry
+            if (batch_.contains(oldValue))
+                batch_.insert(newValue, batch_.take(oldValue));
+            return true;
         }
     }
 
     if (role == WalletContentRole)
     {
         const QString& entry = folderEntries_[index.row()];
+        if (batchDepth_ > 0)
+        {
+            BatchEntry& change = batch_[entry];
+            change.removed = false;
+            change.replace = true;
+            change.content = value.value<WalletContentList>();
+            return true;
+        }
+
         saveEntryContent(entry, value.value<WalletContentList>());
         emit dataChanged(index, index, contentRoles);
         return true;
@@ -169,111 +508,353 @@ bool WalletModel::setData(const QModelIndex& index, const QVariant& value, int r
 
 void WalletModel::onWalletOpened(bool ok)
 {
-    if (ok &&
-        (wallet_->hasFolder(PASSWORD_MANAGER_FOLDER) ||
-        wallet_->createFolder(PASSWORD_MANAGER_FOLDER)) &&
-        wallet_->setFolder(PASSWORD_MANAGER_FOLDER))
+    walletOpen_ = ok;
+    walletOpening_ = false;
+
+    if (ok)
     {
         load();
+
+        // contents asked for while the snapshot was shown were not requested,
+        // the views ask again and the reads are queued after the listing
+        if (!folderEntries_.isEmpty())
+            emit dataChanged(index(0), index(folderEntries_.size() - 1), QVector<int>({WalletContentRole}));
     } else {
+        // the names of the snapshot can not be used without the wallet
+        if (snapshotShown_)
+        {
+            reset(QStringList(), SortKeys());
+            snapshotShown_ = false;
+        }
         getMainFrame()->getStatusBubble()->showText(tr("Wallet could not be opened"), StatusBubble::Long);
     }
 }
 
 void WalletModel::onWalletClosed()
 {
-    delete wallet_;
-    wallet_ = nullptr;
+    walletOpen_ = false;
+    walletContents_.clear();
+    pendingLoads_.clear();
+    staleLoads_.clear();
+    writtenEntries_.clear();
+    externalUpdate_ = false;
+    folderUpdateTimer_.stop();
 }
 
 void WalletModel::onFolderUpdated(const QString& folder)
 {
-    qDebug() << "sender():    " << sender();
-    qDebug() << "WalletModel: " << this;
+    if (folder != PASSWORD_MANAGER_FOLDER)
+        return;
 
-    if (folder == PASSWORD_MANAGER_FOLDER)
-        load();
+    // echoes of our own writes arrive while they are queued or shortly after,
+    // a change of another application at the same time waits for its next one
+    if (pendingWrites_.isEmpty() && writtenEntries_.isEmpty())
+        externalUpdate_ = true;
+
+    folderUpdateTimer_.start();
 }
 
-void WalletModel::ensureOpenWallet()
+void WalletModel::onFolderUpdateTimeout()
 {
-    if (wallet_)
-    {
-        if (wallet_->isOpen())
-            return;
+    if (!walletOpen_)
+        return;
+
+    // the echoes of finished writes have arrived by now
+    QSet<QString> written = writtenEntries_;
+    if (pendingWrites_.isEmpty())
+        writtenEntries_.clear();
 
-        delete wallet_;
+    if (!externalUpdate_)
+        return;
+    externalUpdate_ = false;
+
+    // the notification does not tell the entry, the listing is compared with
+    // the rows and the cached entries not written by us are read again
+    load();
+
+    for (const QString& entry : walletContents_.keys())
+    {
+        if (!written.contains(entry))
+            reloadEntryContent(entry);
     }
+}
 
-    wallet_ = KWallet::Wallet::openWallet(KWallet::Wallet::NetworkWallet(), static_cast<QWidget*>(parent())->winId(),
-        KWallet::Wallet::Asynchronous);
-    connect(wallet_, &KWallet::Wallet::walletOpened, this, &WalletModel::onWalletOpened);
-    connect(wallet_, &KWallet::Wallet::walletClosed, this, &WalletModel::onWalletClosed);
-    connect(wallet_, &KWallet::Wallet::folderUpdated, this, &WalletModel::onFolderUpdated);
+void WalletModel::ensureOpenWallet()
+{
+    if (walletOpen_ || walletOpening_)
+        return;
+
+    walletOpening_ = true;
+    worker_->openWallet(static_cast<QWidget*>(parent()));
 }
 
 void WalletModel::load()
 {
-    QStringList walletEntries = wallet_->entryList();
-    std::sort(walletEntries.begin(), walletEntries.end(),
-              [](const QString& a, const QString& b) -> bool {
-        return compare(a, b) < 0;
+    if (walletOpen_)
+        worker_->entryList();
+}
+
+void WalletModel::onEntryListLoaded(const QStringList& entries)
+{
+    // the sort keys of the known rows are reused
+    updateIndex();
+
+    QStringList walletEntries = entries;
+    SortKeys walletKeys;
+    sortEntries(walletEntries, walletKeys);
+    applyEntries(walletEntries, walletKeys);
+    snapshot_.save(walletEntries);
+    snapshotShown_ = false;
+    buildSearchIndex();
+
+    emit entriesLoaded();
+}
+
+void WalletModel::sortEntries(QStringList& entries, SortKeys& keys) const
+{
+    // the collation runs once per new entry, sorting only compares the keys
+    SortKeys unsorted;
+    unsorted.reserve(entries.size());
+    for (const QString& entry : entries)
+    {
+        auto it = entryRows_.constFind(entry);
+        if (it != entryRows_.constEnd() && it.value() < entryRowsValid_)
+            unsorted.push_back(sortKeys_[it.value()]);
+        else
+            unsorted.push_back(collator_.sortKey(entry));
+    }
+
+    std::vector<int> order(entries.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&entries, &unsorted](int a, int b) {
+        return compare(unsorted[a], entries[a], unsorted[b], entries[b]) < 0;
     });
 
+    QStringList sorted;
+    sorted.reserve(entries.size());
+    keys.clear();
+    keys.reserve(entries.size());
+    for (int i : order)
+    {
+        sorted << entries[i];
+        keys.push_back(unsorted[i]);
+    }
+    entries.swap(sorted);
+}
+
+void WalletModel::applyEntries(const QStringList& walletEntries, const SortKeys& walletKeys)
+{
+    if (folderEntries_.isEmpty() || countChanges(walletEntries, walletKeys) > RESET_THRESHOLD)
+    {
+        reset(walletEntries, walletKeys);
+        return;
+    }
+
+    // merge the sorted lists, contiguous runs of missing or vanished entries
+    // are applied as one range each
     int i = 0;
+    int row = 0;
 
-    while (i < walletEntries.size() && i < folderEntries_.size())
+    auto cmp = [&walletEntries, &walletKeys, &i, this](int r) -> int {
+        if (i >= walletEntries.size())
+            return 1;
+        if (r >= folderEntries_.size())
+            return -1;
+        return compare(walletKeys[i], walletEntries[i], sortKeys_[r], folderEntries_[r]);
+    };
+
+    while (i < walletEntries.size() || row < folderEntries_.size())
     {
-        int cmp = compare(walletEntries[i], folderEntries_[i]);
+        int c = cmp(row);
 
-        if (cmp < 0)
+        if (c < 0)
         {
-            insert(walletEntries[i], createIndex(i, 0));
-            ++i;
+            int first = i;
+            do
+                ++i;
+            while (i < walletEntries.size() && cmp(row) < 0);
+
+            insertRange(row, walletEntries.mid(first, i - first),
+                        SortKeys(walletKeys.begin() + first, walletKeys.begin() + i));
+            row += i - first;
         }
-        else if (cmp > 0)
+        else if (c > 0)
         {
-            remove(createIndex(i, 0));
+            int last = row;
+            while (last + 1 < folderEntries_.size() && cmp(last + 1) > 0)
+                ++last;
+
+            removeRange(row, last);
         }
         else
         {
             ++i;
+            ++row;
         }
     }
 
-    while (i < walletEntries.size())
+    updateIndex();
+}
+
+int WalletModel::countChanges(const QStringList& walletEntries, const SortKeys& walletKeys) const
+{
+    int changes = 0;
+    int i = 0;
+    int row = 0;
+
+    while (i < walletEntries.size() && row < folderEntries_.size())
     {
-        insert(walletEntries[i]);
-        ++i;
+        int cmp = compare(walletKeys[i], walletEntries[i], sortKeys_[row], folderEntries_[row]);
+        if (cmp <= 0)
+            ++i;
+        if (cmp >= 0)
+            ++row;
+        if (cmp != 0)
+            ++changes;
     }
-    while (i < folderEntries_.size())
-        remove(createIndex(i, 0));
+
+    return changes + (walletEntries.size() - i) + (folderEntries_.size() - row);
 }
 
-void WalletModel::save()
+void WalletModel::reset(const QStringList& entries, const SortKeys& keys)
 {
+    beginResetModel();
+
+    folderEntries_ = entries;
+    sortKeys_ = keys;
+    searchIndex_.clear();
+    searchIndexValid_ = false;
+    searchIndexEdits_.clear();
+    searchIndexStale_ = searchIndexBuilding_;
+    entryRows_.clear();
+    entryRows_.reserve(folderEntries_.size());
+    entryRowsValid_ = 0;
+    updateIndex();
+
+    for (const QString& entry : walletContents_.keys())
+    {
+        if (!entryRows_.contains(entry))
+            walletContents_.remove(entry);
+    }
 
+    endResetModel();
 }
 
 QModelIndex WalletModel::find(const QString& entry) const
 {
-    int row = folderEntries_.indexOf(entry);
-    if (row >= 0)
-        return createIndex(row, 0);
+    auto it = entryRows_.constFind(entry);
+    if (it == entryRows_.constEnd())
+        return QModelIndex();
 
-    return QModelIndex();
+    // rows were shifted since the last lookup, the rows from the first
+    // shifted one on are indexed again, O(n) once per burst of edits
+    if (it.value() >= entryRowsValid_)
+    {
+        updateIndex();
+        it = entryRows_.constFind(entry);
+    }
+    return createIndex(it.value(), 0);
 }
 
 QModelIndex WalletModel::findNext(const QString& entry) const
 {
-    int row = 0;
-    for (const QString& e : folderEntries_)
+    return createIndex(lowerBound(entry), 0);
+}
+
+int WalletModel::lowerBound(const QString& entry) const
+{
+    return lowerBound(entry, collator_.sortKey(entry));
+}
+
+int WalletModel::lowerBound(const QString& entry, const QCollatorSortKey& key) const
+{
+    int first = 0;
+    int count = folderEntries_.size();
+    while (count > 0)
     {
-        if (compare(e, entry) > 1)
-            break;
-        ++row;
+        int step = count / 2;
+        if (compare(sortKeys_[first + step], folderEntries_[first + step], key, entry) < 0)
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+    return first;
+}
+
+void WalletModel::updateIndex() const
+{
+    for (int row = qMax(0, entryRowsValid_); row < folderEntries_.size(); ++row)
+        entryRows_[folderEntries_[row]] = row;
+
+    entryRowsValid_ = std::numeric_limits<int>::max();
+}
+
+void WalletModel::buildSearchIndex()
+{
+    if (searchIndexValid_ || searchIndexBuilding_)
+        return;
+
+    // the list is shared with the copy, the rows changed meanwhile are collected
+    const QStringList entries = folderEntries_;
+    searchIndexEdits_.clear();
+    searchIndexBuilding_ = true;
+    searchIndexStale_ = false;
+    searchIndexWatcher_.setFuture(QtConcurrent::run([entries]() {
+        TrigramIndex index;
+        for (const QString& entry : entries)
+            index.insert(entry);
+        return index;
+    }));
+}
+
+void WalletModel::onSearchIndexBuilt()
+{
+    // taken by a search waiting for it
+    if (!searchIndexBuilding_)
+        return;
+    searchIndexBuilding_ = false;
+
+    // built by a search meanwhile, the row changes went into that index
+    if (searchIndexValid_)
+        return;
+
+    if (searchIndexStale_)
+    {
+        searchIndexStale_ = false;
+        buildSearchIndex();
+        return;
+    }
+
+    searchIndex_ = searchIndexWatcher_.result();
+    for (const auto& edit : searchIndexEdits_)
+    {
+        if (edit.second)
+            searchIndex_.insert(edit.first);
+        else
+            searchIndex_.remove(edit.first);
+    }
+    searchIndexEdits_.clear();
+    searchIndexValid_ = true;
+}
+
+void WalletModel::updateSearchIndex(const QString& entry, bool insert)
+{
+    if (searchIndexValid_)
+    {
+        if (insert)
+            searchIndex_.insert(entry);
+        else
+            searchIndex_.remove(entry);
+    }
+    else if (searchIndexBuilding_)
+    {
+        searchIndexEdits_.append(qMakePair(entry, insert));
     }
-    return createIndex(row, 0);
 }
 
 QModelIndex WalletModel::insert(const QString& entry, const QModelIndex& insertPos)
@@ -285,13 +866,44 @@ QModelIndex WalletModel::insert(const QString& entry, const QModelIndex& insertP
     else
         newRow = folderEntries_.size();
 
-    beginInsertRows(QModelIndex(), newRow, newRow);
+    insertRange(newRow, QStringList(entry), SortKeys(1, collator_.sortKey(entry)));
 
-    folderEntries_.insert(newRow, entry);
+    return createIndex(newRow, 0);
+}
 
-    endInsertRows();
+void WalletModel::insertRange(int row, const QStringList& entries, const SortKeys& keys)
+{
+    if (entries.isEmpty())
+        return;
 
-    return createIndex(newRow, 0);
+    beginInsertRows(QModelIndex(), row, row + entries.size() - 1);
+
+    // all following rows are shifted
+    if (row < folderEntries_.size())
+        entryRowsValid_ = qMin(entryRowsValid_, row);
+
+    if (entries.size() == 1)
+    {
+        folderEntries_.insert(row, entries.first());
+    }
+    else
+    {
+        QStringList merged;
+        merged.reserve(folderEntries_.size() + entries.size());
+        merged += folderEntries_.mid(0, row);
+        merged += entries;
+        merged += folderEntries_.mid(row);
+        folderEntries_.swap(merged);
+    }
+    sortKeys_.insert(sortKeys_.begin() + row, keys.begin(), keys.end());
+
+    for (int i = 0; i < entries.size(); ++i)
+    {
+        entryRows_.insert(entries[i], row + i);
+        updateSearchIndex(entries[i], true);
+    }
+
+    endInsertRows();
 }
 
 void WalletModel::walletInsert(const QString& entry)
@@ -301,56 +913,214 @@ void WalletModel::walletInsert(const QString& entry)
 
 void WalletModel::remove(const QModelIndex& index)
 {
-    beginRemoveRows(QModelIndex(), index.row(), index.row());
+    removeRange(index.row(), index.row());
+}
 
-    const QString entry = folderEntries_[index.row()];
-    folderEntries_.removeAt(index.row());
+void WalletModel::removeRange(int first, int last)
+{
+    beginRemoveRows(QModelIndex(), first, last);
+
+    for (int row = first; row <= last; ++row)
+    {
+        const QString& entry = folderEntries_[row];
+        entryRows_.remove(entry);
+        walletContents_.remove(entry);
+        updateSearchIndex(entry, false);
+    }
+    folderEntries_.erase(folderEntries_.begin() + first, folderEntries_.begin() + last + 1);
+    sortKeys_.erase(sortKeys_.begin() + first, sortKeys_.begin() + last + 1);
+    entryRowsValid_ = qMin(entryRowsValid_, last + 1);
 
     endRemoveRows();
 }
 
-bool WalletModel::walletRemove(const QString& entry)
+void WalletModel::walletRemove(const QString& entry)
+{
+    usage_.remove(entry);
+    beginWrite(entry);
+    worker_->removeEntry(entry);
+}
+
+QModelIndex WalletModel::rename(const QModelIndex& index, const QString& newValue)
 {
-    return wallet_->removeEntry(entry) == 0;
+    int row = index.row();
+    QString oldValue = folderEntries_[row];
+
+    // keep the list sorted, the destination is given in the row numbers before the move
+    const QCollatorSortKey key = collator_.sortKey(newValue);
+    int destRow = lowerBound(newValue, key);
+    int newRow = destRow > row ? destRow - 1 : destRow;
+    bool move = destRow != row && destRow != row + 1;
+    if (move)
+        beginMoveRows(QModelIndex(), row, row, QModelIndex(), destRow);
+
+    folderEntries_.move(row, newRow);
+    folderEntries_[newRow] = newValue;
+    sortKeys_.erase(sortKeys_.begin() + row);
+    sortKeys_.insert(sortKeys_.begin() + newRow, key);
+    entryRows_.remove(oldValue);
+    entryRows_.insert(newValue, newRow);
+    entryRowsValid_ = qMin(entryRowsValid_, qMin(row, newRow));
+
+    updateSearchIndex(oldValue, false);
+    updateSearchIndex(newValue, true);
+
+    if (move)
+        endMoveRows();
+
+    WalletContentView* content = walletContents_.take(oldValue);
+    if (content)
+        walletContents_.insert(newValue, content, contentCost(*content));
+
+    return createIndex(newRow, 0);
 }
 
-void WalletModel::rename(const QModelIndex& index, const QString& newValue)
+void WalletModel::walletRename(const QString& oldValue, const QString& newValue)
 {
-    QString oldValue = folderEntries_[index.row()];
-    folderEntries_[index.row()] = newValue;
-    //walletContents_[newValue] = walletContents_[oldValue];
-    //walletContents_.remove(oldValue);
+    usage_.rename(oldValue, newValue);
+    beginWrite(newValue);
+    worker_->renameEntry(oldValue, newValue);
 }
 
-bool WalletModel::walletRename(const QString& oldValue, const QString& newValue)
+bool WalletModel::loadEntryContent(const QString& entry, WalletContentView& content) const
 {
-    return wallet_->renameEntry(oldValue, newValue) == 0;
+    WalletContentView* cached = walletContents_.object(entry);
+    if (cached)
+    {
+        // shares the blob, the strings are decoded by the cells on display
+        content = *cached;
+        return true;
+    }
+
+    requestEntryContent(entry);
+    return false;
 }
 
-WalletContentList WalletModel::loadEntryContent(const QString& entry) const
+void WalletModel::requestEntryContent(const QString& entry) const
 {
-    QByteArray rawData;
-    if (wallet_->readEntry(entry, rawData)) {
+    if (!walletOpen_ || walletContents_.contains(entry) || pendingLoads_.contains(entry))
+        return;
+
+    pendingLoads_.insert(entry);
+    worker_->loadContent(entry);
+}
+
+void WalletModel::reloadEntryContent(const QString& entry) const
+{
+    if (!walletOpen_)
+        return;
+
+    // not merged with a pending read, it may have run before the change
+    pendingLoads_.insert(entry);
+    worker_->loadContent(entry);
+}
+
+void WalletModel::onContentLoaded(const QString& entry, const WalletContentView& content, bool ok)
+{
+    static auto contentRoles = QVector<int>({WalletContentRole});
+
+    pendingLoads_.remove(entry);
+
+    QModelIndex idx = find(entry);
+    if (!ok)
+    {
+        // removed by another client, the listing read before dropped the row
+        if (!idx.isValid())
+            return;
+
         getMainFrame()->getStatusBubble()
                 ->showText(tr("Passwords could not be loaded from wallet"), StatusBubble::Long);
+        return;
     }
 
-    // deserialize
-    QDataStream stream(&rawData, QIODevice::ReadOnly);
-    stream.setVersion(QDataStream::Qt_5_9);
+    // a write queued after the read has already replaced the content,
+    // the entry is read again once the writes are done
+    if (pendingWrites_.contains(entry))
+    {
+        staleLoads_.insert(entry);
+        return;
+    }
 
-    WalletContentList content;
-    stream >> content;
-    return content;
+    if (!idx.isValid())
+        return;
+
+    // reloads after a folder update mostly return what is cached
+    const WalletContentView* cached = walletContents_.object(entry);
+    if (cached && *cached == content)
+        return;
+
+    cacheEntryContent(entry, content);
+    emit dataChanged(idx, idx, contentRoles);
 }
 
 void WalletModel::saveEntryContent(const QString& entry, const WalletContentList& content)
 {
-    QByteArray rawData;
-    QDataStream stream(&rawData, QIODevice::WriteOnly);
-    stream.setVersion(QDataStream::Qt_5_9);
+    WalletContentView* cached = walletContents_.object(entry);
+    if (!cached)
+    {
+        cacheEntryContent(entry, content);
+        beginWrite(entry);
+        worker_->saveContent(entry, content);
+        return;
+    }
+
+    // only the credentials between the unchanged head and tail are written
+    const WalletContentView& old = *cached;
+    int head = 0;
+    while (head < old.size() && head < content.size() && old.at(head) == content.at(head))
+        ++head;
+
+    int tail = 0;
+    while (tail < old.size() - head && tail < content.size() - head
+           && old.at(old.size() - 1 - tail) == content.at(content.size() - 1 - tail))
+        ++tail;
+
+    const int removeCount = old.size() - head - tail;
+    const WalletContentList inserted = content.mid(head, content.size() - head - tail);
+    if (removeCount == 0 && inserted.isEmpty())
+        return;
+
+    cacheEntryContent(entry, content);
+    beginWrite(entry);
+    worker_->updateContent(entry, head, removeCount, inserted);
+}
+
+void WalletModel::onWriteFinished(const QString& entry, bool ok)
+{
+    auto it = pendingWrites_.find(entry);
+    if (it != pendingWrites_.end() && --it.value() == 0)
+    {
+        pendingWrites_.erase(it);
+        if (staleLoads_.remove(entry) && ok && find(entry).isValid())
+            reloadEntryContent(entry);
 
-    stream << content;
+        // waits for the echoes of the last writes, see onFolderUpdated()
+        if (pendingWrites_.isEmpty())
+            folderUpdateTimer_.start();
+    }
+
+    if (ok)
+        return;
 
-    wallet_->writeEntry(entry, rawData, KWallet::Wallet::Stream);
+    staleLoads_.remove(entry);
+    walletContents_.remove(entry);
+    getMainFrame()->getStatusBubble()
+            ->showText(tr("Changes could not be saved to wallet"), StatusBubble::Long);
+    load();
+}
+
+void WalletModel::beginWrite(const QString& entry)
+{
+    ++pendingWrites_[entry];
+    writtenEntries_.insert(entry);
+}
+
+void WalletModel::cacheEntryContent(const QString& entry, const WalletContentView& content) const
+{
+    walletContents_.insert(entry, new WalletContentView(content), contentCost(content));
+}
+
+void WalletModel::cacheEntryContent(const QString& entry, const WalletContentList& content) const
+{
+    cacheEntryContent(entry, WalletContentView(content));
 }
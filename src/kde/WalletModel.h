@@ -18,20 +18,22 @@
 #ifndef WALLETMODEL_H
 #define WALLETMODEL_H
 
+#include "EntrySnapshot.h"
+#include "EntryUsage.h"
 #include "WalletContent.h"
+#include "TrigramIndex.h"
 #include <QAbstractListModel>
-
-#if defined(QT_NO_DEBUG)
-#define PASSWORD_MANAGER_FOLDER "Password Manager"
-#else
-#define PASSWORD_MANAGER_FOLDER "Password Manager (Debug)"
-#endif
-
-namespace KWallet {
-class Wallet;
-}
+#include <QCache>
+#include <QCollator>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <vector>
 
 class QWidget;
+class WalletWorker;
 
 class WalletModel : public QAbstractListModel
 {
@@ -40,6 +42,7 @@ class WalletModel : public QAbstractListModel
 public:
     enum Role
     {
+        // read as WalletContentView, written as WalletContentList
         WalletContentRole = Qt::UserRole + 1
     };
 
@@ -48,44 +51,152 @@ public:
 
     void openWallet();
 
+    // entries with invalid names are not added, an invalid index is returned
     QModelIndex addEntry(const QString& entry);
     QModelIndex addPassword(const QString& entry, const QString& username, const QString& password);
+    // adds the entry if it is missing, its stored credentials are replaced
+    QModelIndex replaceEntry(const QString& entry, const WalletContentList& content);
+    static bool isValidEntry(const QString& entry);
+
+    // the changes until commitBatch() are collected and applied at once, with
+    // as few row signals as possible. Entries added in a batch get their rows
+    // at the commit, their indexes are invalid before. Renames are applied
+    // immediately. Batches may be nested, the outermost commit applies them.
+    void beginBatch();
+    void commitBatch();
 
     QStringList entryList() const;
     bool hasEntry(const QString& entry) const;
+    QModelIndex find(const QString& entry) const;
 
     void removeEntry(const QModelIndex& index);
     void removeEntry(const QString& entry);
 
+    // loads the content of the given rows into the cache in the background
+    void prefetch(int first, int last);
+
+    // reads the entries bypassing the cache, after all writes requested so far
+    QFuture<QList<WalletContentView>> loadContents(const QStringList& entries) const;
+    // the content of the entry if it is cached, the wallet is not read
+    bool cachedContent(const QString& entry, WalletContentView& content) const;
+
+    // rows of the entries matching the search text, best matches first. The
+    // search index is built in the background once the entries are loaded,
+    // an earlier search waits for it.
+    QVector<int> search(const QString& text);
+
+    // records a use of the entry, frequently and recently used entries are
+    // returned by recentEntries()
+    void markUsed(const QModelIndex& index);
+    QStringList recentEntries(int count) const;
+
     Qt::ItemFlags flags(const QModelIndex& index) const override;
     int rowCount(const QModelIndex& parent) const override;
     QVariant data(const QModelIndex& index, int role) const override;
     bool setData(const QModelIndex& index, const QVariant& value, int role) override;
 
+signals:
+    void recentEntriesChanged();
+    // the rows were updated with the entry list of the wallet
+    void entriesLoaded();
+
 private slots:
     void onWalletOpened(bool ok);
     void onWalletClosed();
     void onFolderUpdated(const QString& folder);
+    void onFolderUpdateTimeout();
+    void onEntryListLoaded(const QStringList& entries);
+    void onContentLoaded(const QString& entry, const WalletContentView& content, bool ok);
+    void onWriteFinished(const QString& entry, bool ok);
+    void onSearchIndexBuilt();
 
 private:
+    // changes of an entry collected by a batch
+    struct BatchEntry
+    {
+        BatchEntry() : removed(false), replace(false) {}
+
+        bool removed;
+        // the content replaces the stored credentials instead of being appended
+        bool replace;
+        WalletContentList content;
+    };
+
     void ensureOpenWallet();
     void load();
-    void save();
-    QModelIndex find(const QString& entry) const;
+    // collation keys of a list of entries, in the same order
+    typedef std::vector<QCollatorSortKey> SortKeys;
+
+    void sortEntries(QStringList& entries, SortKeys& keys) const;
+    void applyEntries(const QStringList& entries, const SortKeys& keys);
+    int countChanges(const QStringList& walletEntries, const SortKeys& walletKeys) const;
+    void reset(const QStringList& entries, const SortKeys& keys);
     QModelIndex findNext(const QString& entry) const;
+    int lowerBound(const QString& entry) const;
+    int lowerBound(const QString& entry, const QCollatorSortKey& key) const;
+    void updateIndex() const;
+    void buildSearchIndex();
+    void updateSearchIndex(const QString& entry, bool insert);
     QModelIndex insert(const QString& entry, const QModelIndex& insertPos = QModelIndex());
+    void insertRange(int row, const QStringList& entries, const SortKeys& keys);
     void walletInsert(const QString& entry);
     void remove(const QModelIndex& index);
-    bool walletRemove(const QString& entry);
-    void rename(const QModelIndex& index, const QString& newValue);
-    bool walletRename(const QString& oldValue, const QString& newValue);
-    WalletContentList loadEntryContent(const QString& entry) const;
+    void removeRange(int first, int last);
+    void walletRemove(const QString& entry);
+    QModelIndex rename(const QModelIndex& index, const QString& newValue);
+    void walletRename(const QString& oldValue, const QString& newValue);
+    bool loadEntryContent(const QString& entry, WalletContentView& content) const;
+    void requestEntryContent(const QString& entry) const;
+    void reloadEntryContent(const QString& entry) const;
     void saveEntryContent(const QString& entry, const WalletContentList& content);
+    void cacheEntryContent(const QString& entry, const WalletContentView& content) const;
+    void cacheEntryContent(const QString& entry, const WalletContentList& content) const;
+    void beginWrite(const QString& entry);
 
 private:
-    KWallet::Wallet* wallet_;
+    WalletWorker* worker_;
+    bool walletOpen_;
+    // an open request is running, the user may still be asked for input
+    bool walletOpening_;
     QStringList folderEntries_;
-    //QMap<QString, WalletContentList> walletContents_;
+    // entries are ordered by the collation of the current locale
+    QCollator collator_;
+    SortKeys sortKeys_;
+    // row of every entry, only rows below entryRowsValid_ are up to date, the
+    // rest is updated by the next find()
+    mutable QHash<QString, int> entryRows_;
+    mutable int entryRowsValid_;
+    // parsed entry contents, least recently used are dropped first
+    mutable QCache<QString, WalletContentView> walletContents_;
+    // entries with a read request in the worker queue
+    mutable QSet<QString> pendingLoads_;
+    // entries whose read was dropped because of a pending write
+    QSet<QString> staleLoads_;
+    // fuzzy search over the entry names, built in the thread pool
+    TrigramIndex searchIndex_;
+    bool searchIndexValid_;
+    bool searchIndexBuilding_;
+    QFutureWatcher<TrigramIndex> searchIndexWatcher_;
+    // row changes during the build, applied to its result (true for inserts)
+    QVector<QPair<QString, bool>> searchIndexEdits_;
+    // the rows were reset during the build, its result is dropped
+    bool searchIndexStale_;
+    // number of queued write requests per entry, reads finishing before are outdated
+    QHash<QString, int> pendingWrites_;
+    // entries written since the last folder update, their notifications are
+    // our own and not reloaded
+    QSet<QString> writtenEntries_;
+    // a notification arrived while no write of ours was outstanding
+    bool externalUpdate_;
+    // collects folderUpdated notifications into a single reload
+    QTimer folderUpdateTimer_;
+    // entry names of the last session, shown until the wallet is open
+    EntrySnapshot snapshot_;
+    // the rows come from the snapshot and not from the wallet
+    bool snapshotShown_;
+    EntryUsage usage_;
+    int batchDepth_;
+    QHash<QString, BatchEntry> batch_;
 };
 
 #endif // WALLETMODEL_H
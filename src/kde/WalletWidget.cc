@@ -17,22 +17,51 @@
 
 #include "WalletWidget.h"
 #include "WalletModel.h"
+#include "WalletFilterModel.h"
+#include "WalletImporter.h"
+#include "WalletExporter.h"
+#include "PasswordReuseAudit.h"
+#include "PasswordStrengthAudit.h"
+#include "BreachAudit.h"
+#include "AuditDialog.h"
+#include "CredentialModel.h"
 #include "../main.h"
+#include "../BreachChecker.h"
 #include "../MainFrame.h"
 #include "../StatusBubble.h"
 #include "../helper.h"
 
 #include <QInputDialog>
+#include <QFileDialog>
 #include <QListWidget>
+#include <QMenu>
 #include <QBuffer>
 #include <QDataStream>
-#include <QLabel>
-#include <QPushButton>
+#include <QHeaderView>
 #include <QMessageBox>
+#include <QPointer>
 #include <QClipboard>
 #include <QItemSelectionModel>
+#include <QShortcut>
+#include <QTreeWidget>
 #include <QDebug>
 
+namespace {
+
+// time in ms after the last edit until the entry is written to the wallet
+const int SAVE_DELAY = 500;
+
+// upper bound of visible rows to prefetch on a selection change
+const int MAX_PREFETCH_ROWS = 64;
+
+// time in ms an entry has to stay selected to count as used
+const int USE_DELAY = 1500;
+
+// entries shown in the recent list, selected with Ctrl+1 and following
+const int RECENT_COUNT = 5;
+
+}
+
 class WalletWidgetDelegate : public WalletDelegate {
 public:
     WalletWidgetDelegate(WalletWidget* widget) : widget(widget)
@@ -67,45 +96,6 @@ WalletDelegate* createWallet()
     return new WalletWidgetDelegate(new WalletWidget());
 }
 
-WalletWidget::Fields::Fields(QWidget* pane, int num) : pane(pane)
-{
-    username = pane->findChild<QLineEdit*>(QString("username_%1").arg(num));
-    password = pane->findChild<QLineEdit*>(QString("password_%1").arg(num));
-}
-
-WalletWidget::Fields::Fields(const WalletWidget::Fields& o) : pane(o.pane), username(o.username),
-    password(o.password)
-{
-}
-
-WalletWidget::Fields& WalletWidget::Fields::operator=(const WalletWidget::Fields& o)
-{
-    pane = o.pane;
-    username = o.username;
-    password = o.password;
-    return *this;
-}
-
-void WalletWidget::Fields::fillData(const WalletContent& content)
-{
-    pane->setVisible(true);
-    username->setText(content.username());
-    password->setText(content.password());
-}
-
-void WalletWidget::Fields::copyDataFrom(const Fields& other)
-{
-    username->setText(other.username->text());
-    password->setText(other.password->text());
-}
-
-void WalletWidget::Fields::clearData()
-{
-    username->setText(QString());
-    password->setText(QString());
-    pane->setVisible(false);
-}
-
 WalletWidget::WalletWidget() :
     ui(new Ui::WalletWidget())
 {
@@ -115,21 +105,87 @@ WalletWidget::WalletWidget() :
 
 WalletWidget::~WalletWidget()
 {
+    flushEntryContent();
     delete ui;
 }
 
+void WalletWidget::showEvent(QShowEvent* event)
+{
+    // a wallet that could not be opened is tried again, asking the user anew
+    walletModel_->openWallet();
+    QWidget::showEvent(event);
+}
+
+void WalletWidget::hideEvent(QHideEvent* event)
+{
+    flushEntryContent();
+    QWidget::hideEvent(event);
+}
+
 void WalletWidget::init()
 {
     walletModel_ = new WalletModel(this);
+    filterModel_ = new WalletFilterModel(walletModel_, this);
+    credentialModel_ = new CredentialModel(this);
+
+    ui->credentialView->setModel(credentialModel_);
+    ui->credentialView->setItemDelegate(new CredentialDelegate(this));
+    ui->credentialView->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    connect(credentialModel_, &CredentialModel::contentEdited, this, &WalletWidget::onEntryContentSubmitted);
+
+    saveTimer_.setSingleShot(true);
+    saveTimer_.setInterval(SAVE_DELAY);
+    connect(&saveTimer_, &QTimer::timeout, this, &WalletWidget::flushEntryContent);
+
+    useTimer_.setSingleShot(true);
+    useTimer_.setInterval(USE_DELAY);
+    connect(&useTimer_, &QTimer::timeout, this, [this]() { walletModel_->markUsed(selectedIndex()); });
+
+    recentTimer_.setSingleShot(true);
+    recentTimer_.setInterval(0);
+    connect(&recentTimer_, &QTimer::timeout, this, &WalletWidget::updateRecentList);
+    connect(walletModel_, &WalletModel::recentEntriesChanged, &recentTimer_, QOverload<>::of(&QTimer::start));
+    connect(walletModel_, &WalletModel::modelReset, &recentTimer_, QOverload<>::of(&QTimer::start));
+    connect(walletModel_, &WalletModel::rowsInserted, &recentTimer_, QOverload<>::of(&QTimer::start));
+    connect(walletModel_, &WalletModel::rowsRemoved, &recentTimer_, QOverload<>::of(&QTimer::start));
+
+    connect(ui->recentList, &QListWidget::itemClicked, this, [this](QListWidgetItem* item) {
+        selectRecent(ui->recentList->row(item));
+    });
+    for (int i = 0; i < RECENT_COUNT; ++i)
+    {
+        QShortcut* shortcut = new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_1 + i), this);
+        connect(shortcut, &QShortcut::activated, this, [this, i]() { selectRecent(i); });
+    }
+    updateRecentList();
 
     QItemSelectionModel* selectionModel = ui->entryList->selectionModel();
-    ui->entryList->setModel(walletModel_);
+    ui->entryList->setModel(filterModel_);
     delete selectionModel;
 
     ui->entryList->setSelectionMode(QAbstractItemView::SingleSelection);
+    ui->entryList->setUniformItemSizes(true);
 
     connect(ui->entryList->selectionModel(), &QItemSelectionModel::selectionChanged,
             this, &WalletWidget::onListEntryChanged);
+    connect(walletModel_, &WalletModel::dataChanged, this, &WalletWidget::onModelDataChanged);
+    connect(ui->searchEdit, &QLineEdit::textChanged, this, &WalletWidget::onSearchTextChanged);
+
+    QMenu* auditMenu = new QMenu(this);
+    auditMenu->addAction(tr("Reused passwords"), this, [this]() {
+        runAudit(new PasswordReuseAudit(walletModel_, this));
+    });
+    auditMenu->addAction(tr("Weak passwords"), this, [this]() {
+        runAudit(new PasswordStrengthAudit(walletModel_, this));
+    });
+    QAction* breachAction = auditMenu->addAction(tr("Breached passwords"), this, [this]() {
+        runAudit(new BreachAudit(getMainFrame()->getBreachChecker(), walletModel_, this));
+    });
+    // the corpus is optional and has to be downloaded separately
+    connect(auditMenu, &QMenu::aboutToShow, this, [breachAction]() {
+        breachAction->setEnabled(getMainFrame()->getBreachChecker()->isOpen());
+    });
+    ui->auditBtn->setMenu(auditMenu);
 
     onListEntryChanged(QItemSelection(), QItemSelection());
 
@@ -138,8 +194,11 @@ void WalletWidget::init()
 
 bool WalletWidget::savePassword(const QString& entry, const QString& username, const QString& password)
 {
+    if (!WalletModel::isValidEntry(entry))
+        return false;
+
     QModelIndex pwIndex = walletModel_->addPassword(entry, username, password);
-    ui->entryList->selectionModel()->select(pwIndex, QItemSelectionModel::ClearAndSelect);
+    select(pwIndex);
 
     return true;
 }
@@ -149,9 +208,33 @@ QStringList WalletWidget::entryList()
     return walletModel_->entryList();
 }
 
+QModelIndex WalletWidget::selectedIndex() const
+{
+    QModelIndexList indexList = ui->entryList->selectionModel()->selectedIndexes();
+    return indexList.isEmpty() ? QModelIndex() : filterModel_->mapToSource(indexList[0]);
+}
+
+void WalletWidget::select(const QModelIndex& index)
+{
+    QModelIndex viewIndex = filterModel_->mapFromSource(index);
+    if (!viewIndex.isValid() && index.isValid())
+    {
+        // hidden by the search, show all entries again
+        ui->searchEdit->clear();
+        viewIndex = filterModel_->mapFromSource(index);
+    }
+
+    ui->entryList->selectionModel()->select(viewIndex, QItemSelectionModel::ClearAndSelect);
+    ui->entryList->scrollTo(viewIndex);
+}
+
 void WalletWidget::onListEntryChanged(const QItemSelection& selected, const QItemSelection& deselected)
 {
+    // the fields still show the previous entry
+    flushEntryContent();
+
     if (selected.indexes().isEmpty()) {
+        useTimer_.stop();
         ui->contentPages->setCurrentWidget(ui->emptyPage);
         ui->removeEntryBtn->setEnabled(false);
         return;
@@ -159,8 +242,58 @@ void WalletWidget::onListEntryChanged(const QItemSelection& selected, const QIte
 
     ui->contentPages->setCurrentWidget(ui->contentWidget);
     ui->removeEntryBtn->setEnabled(true);
+    useTimer_.start();
+
+    QModelIndex viewIndex = selected.first().topLeft();
+    loadContent(filterModel_->mapToSource(viewIndex));
+    prefetchNeighbours(viewIndex);
+}
+
+void WalletWidget::onSearchTextChanged(const QString& text)
+{
+    QPersistentModelIndex selected = selectedIndex();
+
+    // the selection stays on its entry, it is dropped without notification
+    // when the entry is filtered out
+    filterModel_->setFilterText(text);
+
+    QModelIndex viewIndex = filterModel_->mapFromSource(selected);
+    if (viewIndex.isValid())
+    {
+        ui->entryList->selectionModel()->select(viewIndex, QItemSelectionModel::ClearAndSelect);
+        ui->entryList->scrollTo(viewIndex);
+    }
+    else
+    {
+        onListEntryChanged(QItemSelection(), QItemSelection());
+    }
+}
+
+void WalletWidget::updateRecentList()
+{
+    const QStringList entries = walletModel_->recentEntries(RECENT_COUNT);
+
+    ui->recentList->clear();
+    ui->recentList->addItems(entries);
+    for (int i = 0; i < entries.size(); ++i)
+        ui->recentList->item(i)->setToolTip(QKeySequence(Qt::CTRL + Qt::Key_1 + i).toString(QKeySequence::NativeText));
+
+    ui->recentList->setVisible(!entries.isEmpty());
+    if (!entries.isEmpty())
+    {
+        ui->recentList->setFixedHeight(
+                    entries.size() * ui->recentList->sizeHintForRow(0) + 2 * ui->recentList->frameWidth());
+    }
+}
+
+void WalletWidget::selectRecent(int row)
+{
+    QListWidgetItem* item = ui->recentList->item(row);
+    if (!item)
+        return;
 
-    loadContent(selected.first().topLeft());
+    select(walletModel_->find(item->text()));
+    ui->entryList->setFocus();
 }
 
 void WalletWidget::loadContent(const QModelIndex& selectedIndex)
@@ -168,46 +301,86 @@ void WalletWidget::loadContent(const QModelIndex& selectedIndex)
     if (!selectedIndex.isValid())
         return;
 
-    WalletContentList contentList = walletModel_->data(
-                selectedIndex,
-                WalletModel::WalletContentRole)
-            .value<WalletContentList>();
+    QVariant content = walletModel_->data(selectedIndex, WalletModel::WalletContentRole);
 
-    int pos = 0;
+    // show an empty, disabled list until the model delivers the content
+    pendingIndex_ = content.isValid() ? QPersistentModelIndex() : QPersistentModelIndex(selectedIndex);
+    ui->contentWidget->setEnabled(content.isValid());
 
-    for (WalletContent& content : contentList)
-    {
-        fields(pos)->fillData(content);
+    shownContent_ = content.value<WalletContentView>();
+    credentialModel_->setContent(shownContent_);
+}
 
-        ++pos;
-    }
+void WalletWidget::prefetchNeighbours(const QModelIndex& viewIndex)
+{
+    int row = viewIndex.row();
 
-    fieldsVisible = pos;
-    for (int i = pos; i < fieldsList.length(); ++i) {
-        fieldsList[i].clearData();
+    // the adjacent rows are the most likely next selection, so queue them first
+    prefetchRows(row - 1, row + 1);
+
+    QModelIndex top = ui->entryList->indexAt(QPoint(0, 0));
+    QModelIndex bottom = ui->entryList->indexAt(QPoint(0, ui->entryList->viewport()->height() - 1));
+    int first = top.isValid() ? top.row() : 0;
+    int last = bottom.isValid() ? bottom.row() : filterModel_->rowCount() - 1;
+
+    prefetchRows(first, qMin(last, first + MAX_PREFETCH_ROWS - 1));
+}
+
+void WalletWidget::prefetchRows(int first, int last)
+{
+    // the visible rows are not contiguous in the wallet model while searching
+    last = qMin(last, filterModel_->rowCount() - 1);
+    for (int row = qMax(0, first); row <= last; ++row)
+    {
+        int sourceRow = filterModel_->mapToSource(filterModel_->index(row, 0)).row();
+        walletModel_->prefetch(sourceRow, sourceRow);
     }
 }
 
-void WalletWidget::saveEntryContent()
+void WalletWidget::onModelDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight,
+                                      const QVector<int>& roles)
 {
-    QModelIndexList indexList = ui->entryList->selectionModel()->selectedIndexes();
-    if (indexList.isEmpty())
+    if (!pendingIndex_.isValid() || !roles.contains(WalletModel::WalletContentRole))
         return;
 
-    WalletContentList contentList;
-    for (Fields& f : fieldsList)
-    {
-        if (!f.pane->isVisible())
-            continue;
+    int row = pendingIndex_.row();
+    if (row >= topLeft.row() && row <= bottomRight.row())
+        loadContent(pendingIndex_);
+}
 
-        const QString username = f.username->text();
-        const QString password = f.password->text();
-        if (!username.isEmpty() || !password.isEmpty()) {
-            contentList << WalletContent(username, password);
-        }
-    }
+void WalletWidget::scheduleSave()
+{
+    QModelIndex index = selectedIndex();
+    if (!index.isValid())
+        return;
 
-    walletModel_->setData(indexList[0], QVariant::fromValue(contentList), WalletModel::WalletContentRole);
+    editedIndex_ = index;
+    saveTimer_.start();
+}
+
+void WalletWidget::flushEntryContent()
+{
+    if (!saveTimer_.isActive())
+        return;
+
+    saveTimer_.stop();
+    saveEntryContent(editedIndex_);
+}
+
+void WalletWidget::saveEntryContent(const QModelIndex& index)
+{
+    if (!index.isValid())
+        return;
+
+    WalletContentList contentList = credentialModel_->content();
+    WalletContentView content(contentList);
+
+    // nothing changed since the last load or write
+    if (content == shownContent_)
+        return;
+
+    shownContent_ = content;
+    walletModel_->setData(index, QVariant::fromValue(contentList), WalletModel::WalletContentRole);
 }
 
 void WalletWidget::onAddEntryBtnPressed()
@@ -225,17 +398,22 @@ void WalletWidget::onAddEntryBtnPressed()
                         this,
                         tr("Context exists"),
                         tr("A context with this name already exists"));
+        } else if (!WalletModel::isValidEntry(name)) {
+            QMessageBox::information(
+                        this,
+                        tr("Invalid name"),
+                        tr("The name contains a control character that is not allowed"));
         } else {
             QModelIndex idx = walletModel_->addEntry(name);
-            ui->entryList->selectionModel()->select(idx, QItemSelectionModel::ClearAndSelect);
+            select(idx);
         }
     }
 }
 
 void WalletWidget::onRemoveEntryBtnPressed()
 {
-    QModelIndexList indexList = ui->entryList->selectionModel()->selectedIndexes();
-    if (!indexList.isEmpty())
+    QModelIndex index = selectedIndex();
+    if (index.isValid())
     {
         QMessageBox::StandardButton btn =
             QMessageBox::question(
@@ -245,180 +423,211 @@ void WalletWidget::onRemoveEntryBtnPressed()
                     QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
         if (btn != QMessageBox::Yes)
             return;
-        walletModel_->removeEntry(indexList[0]);
+        walletModel_->removeEntry(index);
     }
 }
 
-void WalletWidget::removePassword(int pos)
+void WalletWidget::onImportBtnPressed()
 {
-    QToolButton* button = qobject_cast<QToolButton*>(sender());
-    if (button != 0)
+    QString fileName = QFileDialog::getOpenFileName(
+                this,
+                tr("Import passwords"), QString(),
+                tr("Password exports (*.csv *.xml *.pmex);;CSV files (*.csv);;KeePass 2 XML (*.xml);;"
+                   "Password archives (*.pmex)"));
+    if (fileName.isEmpty())
+        return;
+
+    const WalletImporter::Format format = WalletImporter::formatOf(fileName);
+    QString passphrase;
+    if (format == WalletImporter::Archive)
     {
-        pos = getPanePos(button);
+        bool ok;
+        passphrase = QInputDialog::getText(
+                    this,
+                    tr("Import passwords"), tr("Enter the passphrase of the archive"),
+                    QLineEdit::Password, QString(), &ok);
+        if (!ok)
+            return;
     }
 
-    if (pos < 0)
+    flushEntryContent();
+
+    WalletImporter* importer = new WalletImporter(walletModel_, this);
+    connect(importer, &WalletImporter::finished, this, [this, importer](bool ok) {
+        if (ok)
+            getMainFrame()->getStatusBubble()->showText(
+                        tr("%n password(s) imported", "", importer->importedCount()));
+        else
+            QMessageBox::warning(this, tr("Import passwords"), importer->errorString());
+
+        ui->importBtn->setEnabled(true);
+        importer->deleteLater();
+    });
+
+    ui->importBtn->setEnabled(false);
+    importer->start(fileName, format, passphrase);
+}
+
+void WalletWidget::onExportBtnPressed()
+{
+    QString fileName = QFileDialog::getSaveFileName(
+                this,
+                tr("Export passwords"), QString(),
+                tr("Password archives (*.pmex)"));
+    if (fileName.isEmpty())
+        return;
+
+    bool ok;
+    QString passphrase = QInputDialog::getText(
+                this,
+                tr("Export passwords"), tr("Choose a passphrase for the archive"),
+                QLineEdit::Password, QString(), &ok);
+    if (!ok || passphrase.isEmpty())
+        return;
+
+    QString confirmation = QInputDialog::getText(
+                this,
+                tr("Export passwords"), tr("Repeat the passphrase"),
+                QLineEdit::Password, QString(), &ok);
+    if (!ok)
         return;
 
-    QString username = fieldsList[pos].username->text();
-    if (!username.isEmpty() || !fieldsList[pos].password->text().isEmpty())
+    if (confirmation != passphrase)
+    {
+        QMessageBox::warning(this, tr("Export passwords"), tr("The passphrases do not match"));
+        return;
+    }
+
+    // pending edits are queued before the export reads the entries
+    flushEntryContent();
+
+    WalletExporter* exporter = new WalletExporter(walletModel_, this);
+    connect(exporter, &WalletExporter::finished, this, [this, exporter](bool ok) {
+        if (ok)
+            getMainFrame()->getStatusBubble()->showText(tr("Passwords exported"));
+        else
+            QMessageBox::warning(this, tr("Export passwords"), exporter->errorString());
+
+        ui->exportBtn->setEnabled(true);
+        exporter->deleteLater();
+    });
+
+    ui->exportBtn->setEnabled(false);
+    if (!exporter->start(fileName, passphrase))
+    {
+        QMessageBox::warning(this, tr("Export passwords"), exporter->errorString());
+        ui->exportBtn->setEnabled(true);
+        delete exporter;
+    }
+}
+
+void WalletWidget::runAudit(WalletAudit* audit)
+{
+    // pending edits are saved before the audit reads the entries
+    flushEntryContent();
+
+    // the dialog shows the progress and may be closed before the audit finished
+    QPointer<AuditDialog> dialog = new AuditDialog(audit->title(), this);
+    dialog->setSummary(tr("Checking the entries..."));
+    connect(dialog, &AuditDialog::entryActivated, this, [this](const QString& entry) {
+        select(walletModel_->find(entry));
+    });
+
+    connect(audit, &WalletAudit::progress, this, [audit, dialog](int checked, int total) {
+        if (!dialog)
+            return;
+        dialog->setSummary(tr("Checked %1 of %2 entries").arg(checked).arg(total));
+        audit->reportChecked(dialog);
+    });
+    connect(audit, &WalletAudit::finished, this, [this, audit, dialog](bool ok) {
+        ui->auditBtn->setEnabled(true);
+        audit->deleteLater();
+
+        if (!ok)
+        {
+            QMessageBox::warning(this, audit->title(), audit->errorString());
+            if (dialog)
+                dialog->close();
+            return;
+        }
+
+        if (dialog)
+            audit->report(dialog);
+    });
+
+    ui->auditBtn->setEnabled(false);
+    dialog->show();
+    audit->start();
+}
+
+void WalletWidget::removePassword()
+{
+    int row = currentCredential();
+    if (row < 0)
+        return;
+
+    // copied, the model may change while the dialog is open
+    const QPersistentModelIndex index = credentialModel_->index(row, CredentialModel::UsernameColumn);
+    const WalletContent credential = credentialModel_->credential(row);
+    if (!credential.username().isEmpty() || !credential.password().isEmpty())
     {
         QMessageBox::StandardButton btn = QMessageBox::question(
                     this,
                     tr("Remove password"),
-                    tr("Do you want to remove the password %1?").arg(username),
+                    tr("Do you want to remove the password %1?").arg(credential.username()),
                     QMessageBox::Yes | QMessageBox::No,
                     QMessageBox::No);
         if (btn != QMessageBox::Yes)
             return;
-    }
 
-    for (; pos < fieldsList.length() - 1; ++pos)
-    {
-        fieldsList[pos].copyDataFrom(fieldsList[pos + 1]);
+        // another entry was selected or the entry was reloaded in the meantime
+        if (!index.isValid() || credentialModel_->credential(index.row()) != credential)
+            return;
+        row = index.row();
     }
 
-    fieldsList[pos].clearData();
-    saveEntryContent();
+    credentialModel_->removeRow(row);
 }
 
-void WalletWidget::copyPassword(int pos)
+void WalletWidget::copyPassword()
 {
-    QToolButton* button = qobject_cast<QToolButton*>(sender());
-    if (button != 0)
-    {
-        pos = getPanePos(button);
-    }
-
-    if (pos < 0)
+    int row = currentCredential();
+    if (row < 0)
         return;
 
-    QString username = fieldsList[pos].username->text();
-    QString passwd = fieldsList[pos].password->text();
-    if (passwd.isEmpty())
+    const WalletContent credential = credentialModel_->credential(row);
+    if (credential.password().isEmpty())
     {
         return;
     }
-    QApplication::clipboard()->setText(passwd);
+    QApplication::clipboard()->setText(credential.password());
+    walletModel_->markUsed(selectedIndex());
 
     getMainFrame()->getStatusBubble()->showText(
-                tr("Password for %1 copied to clipboard").arg(username));
+                tr("Password for %1 copied to clipboard").arg(credential.username()));
 }
 
 void WalletWidget::onAddPasswordBtnPressed()
 {
-    appendPasswordFields();
+    int row = credentialModel_->appendCredential();
+
+    QModelIndex index = credentialModel_->index(row, CredentialModel::UsernameColumn);
+    ui->credentialView->setCurrentIndex(index);
+    ui->credentialView->edit(index);
 }
 
 void WalletWidget::onShowPasswordsPressed()
 {
-    QLineEdit::EchoMode echoMode = ui->showPasswordsCheck->isChecked() ?
-                QLineEdit::Normal : QLineEdit::Password;
-    for (int i = 0; i < fieldsList.length(); ++i)
-    {
-        fieldsList[i].password->setEchoMode(echoMode);
-    }
+    credentialModel_->setPasswordsVisible(ui->showPasswordsCheck->isChecked());
 }
 
 void WalletWidget::onEntryContentSubmitted()
 {
-    saveEntryContent();
-}
-
-WalletWidget::Fields* WalletWidget::fields(int pos)
-{
-    if (pos >= fieldsList.length()) {
-        QWidget* lastPane = findChild<QWidget*>(QString("entryPane_%1").arg(qMax(0, fieldsList.length() - 1)));
-
-        for (int i = fieldsList.length(); i <= pos; ++i) {
-            lastPane = createFieldsPane(lastPane, i);
-            Fields fields(lastPane, i);
-
-            fields.password->setEchoMode(ui->showPasswordsCheck->isChecked() ?
-                                             QLineEdit::Normal : QLineEdit::Password);
-
-            fieldsList << fields;
-        }
-    }
-    return &fieldsList[pos];
-}
-
-QWidget* WalletWidget::createFieldsPane(QWidget* previous, int num)
-{
-    static QIcon removeIcon;
-    if (removeIcon.isNull())
-        removeIcon = loadIcon(QString::fromUtf8("list-remove"));
-    static QIcon copyIcon;
-    if (copyIcon.isNull())
-        copyIcon = loadIcon(QString::fromUtf8("edit-copy"));
-
-    QWidget* pane = new QWidget(ui->entryPaneContent);
-    pane->setObjectName(QString("entryPane_%1").arg(num));
-    QSizePolicy sizePolicy(QSizePolicy::Preferred, QSizePolicy::Maximum);
-    sizePolicy.setHorizontalStretch(0);
-    sizePolicy.setVerticalStretch(0);
-    sizePolicy.setHeightForWidth(pane->sizePolicy().hasHeightForWidth());
-    pane->setSizePolicy(sizePolicy);
-    pane->setMaximumSize(QSize(16777215, 16777215));
-    QHBoxLayout* layout = new QHBoxLayout(pane);
-    layout->setContentsMargins(0, 0, 0, 0);
-    layout->setObjectName(QString("paneLayout_%1").arg(num));
-
-    QLabel* noLabel = new QLabel(pane);
-    noLabel->setObjectName(QString("usrLabel_%1").arg(num));
-    noLabel->setText(tr("#%1").arg(num));
-    layout->addWidget(noLabel);
-
-    QLineEdit* username = new QLineEdit(pane);
-    username->setObjectName(QString("username_%1").arg(num));
-    username->setPlaceholderText(tr("Username"));
-    layout->addWidget(username);
-
-    QLineEdit* password = new QLineEdit(pane);
-    password->setObjectName(QString("password_%1").arg(num));
-    password->setPlaceholderText(tr("Password"));
-    password->setEchoMode(ui->showPasswordsCheck->isChecked() ? QLineEdit::Normal : QLineEdit::Password);
-    layout->addWidget(password);
-
-    QToolButton* copyPasswordBtn = new QToolButton(pane);
-    copyPasswordBtn->setObjectName(QString("copyPassword_%1").arg(num));
-    copyPasswordBtn->setIcon(copyIcon);
-    layout->addWidget(copyPasswordBtn);
-
-    QToolButton* removePasswordBtn = new QToolButton(pane);
-    removePasswordBtn->setObjectName(QString("removePassword_%1").arg(num));
-    removePasswordBtn->setIcon(removeIcon);
-    layout->addWidget(removePasswordBtn);
-
-    connect(username, &QLineEdit::editingFinished, this, &WalletWidget::onEntryContentSubmitted);
-    connect(password, &QLineEdit::editingFinished, this, &WalletWidget::onEntryContentSubmitted);
-    connect(copyPasswordBtn, &QToolButton::clicked, this, &WalletWidget::copyPassword);
-    connect(removePasswordBtn, &QToolButton::clicked, this, &WalletWidget::removePassword);
-
-    int pos = previous ? ui->entryPaneLayout->indexOf(previous) + 1 : 1;
-    ui->entryPaneLayout->insertWidget(pos, pane);
-
-    return pane;
-}
-
-int WalletWidget::getPanePos(QToolButton* button)
-{
-    int pos;
-    QWidget* pane = button->parentWidget();
-    for (pos = 0; pos < fieldsList.length(); ++pos) {
-        if (pane == fieldsList[pos].pane)
-            break;
-    }
-    if (pos == fieldsList.length())
-        return -1;
-
-    return pos;
+    scheduleSave();
 }
 
-void WalletWidget::appendPasswordFields()
+int WalletWidget::currentCredential() const
 {
-    Fields* fields0 = fields(fieldsVisible);
-    ++fieldsVisible;
-
-    fields0->pane->setVisible(true);
+    QModelIndex index = ui->credentialView->currentIndex();
+    return index.isValid() ? index.row() : -1;
 }
@@ -21,9 +21,12 @@
 #include "ui_WalletWidget.h"
 #include "WalletContent.h"
 #include "../WalletDelegate.h"
+#include <QTimer>
 
 class WalletModel;
-class QToolButton;
+class WalletFilterModel;
+class CredentialModel;
+class WalletAudit;
 
 class WalletWidget : public QWidget {
     Q_OBJECT
@@ -38,50 +41,57 @@ public:
     bool savePassword(const QString& entry, const QString& username, const QString& password);
     QStringList entryList();
 
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
 private slots:
     void onListEntryChanged(const QItemSelection& selected, const QItemSelection& deselected);
+    void onSearchTextChanged(const QString& text);
+    void updateRecentList();
+    void selectRecent(int row);
     void onAddEntryBtnPressed();
     void onRemoveEntryBtnPressed();
+    void onImportBtnPressed();
+    void onExportBtnPressed();
     void onAddPasswordBtnPressed();
-    void copyPassword(int pos=-1);
-    void removePassword(int pos=-1);
+    void copyPassword();
+    void removePassword();
     void onShowPasswordsPressed();
     void onEntryContentSubmitted();
+    void onModelDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight,
+                            const QVector<int>& roles);
 
 private:
-    struct Fields {
-        QWidget* pane;
-        QLineEdit* username;
-        QLineEdit* password;
-
-        Fields(QWidget* pane, int num);
-
-        Fields(const Fields& o);
-
-        Fields& operator=(const Fields& o);
-
-        void fillData(const WalletContent& content);
-
-        void copyDataFrom(const Fields& other);
-
-        void clearData();
-    };
-
     Ui::WalletWidget* ui;
 
     WalletModel* walletModel_;
+    WalletFilterModel* filterModel_;
+    CredentialModel* credentialModel_;
 
-    QList<Fields> fieldsList;
-    int fieldsVisible;
     QString entryToSelect;
+    // selected entry whose content is still being loaded
+    QPersistentModelIndex pendingIndex_;
+    // edits are written after a short delay, all of them in one go
+    QTimer saveTimer_;
+    QPersistentModelIndex editedIndex_;
+    WalletContentView shownContent_;
+    // an entry counts as used when it stays selected for a moment
+    QTimer useTimer_;
+    // collects model changes into a single update of the recent list
+    QTimer recentTimer_;
 
     void init();
+    QModelIndex selectedIndex() const;
+    void select(const QModelIndex& index);
     void loadContent(const QModelIndex& selectedIndex);
-    Fields* fields(int pos);
-    QWidget* createFieldsPane(QWidget* previous, int num);
-    int getPanePos(QToolButton* button);
-    void appendPasswordFields();
-    void saveEntryContent();
+    void prefetchNeighbours(const QModelIndex& viewIndex);
+    void prefetchRows(int first, int last);
+    int currentCredential() const;
+    void scheduleSave();
+    void flushEntryContent();
+    void saveEntryContent(const QModelIndex& index);
+    void runAudit(WalletAudit* audit);
 };
 
 #endif	/* _WALLETWIDGET_H */
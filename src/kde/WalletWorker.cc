@@ -0,0 +1,440 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "WalletWorker.h"
+#include "WalletBackend.h"
+#include <QFutureInterface>
+#include <QMutexLocker>
+#include <algorithm>
+
+namespace {
+
+// time in ms without requests before the backend does its maintenance
+const int IDLE_DELAY = 5000;
+
+// separates the entry name from the credential id in the wallet keys
+const QChar KEY_SEPARATOR(0x1f);
+
+QString credentialKey(const QString& entry, quint32 id)
+{
+    return entry + KEY_SEPARATOR + QString::number(id);
+}
+
+}
+
+WalletWorker::WalletWorker(QObject* parent) :
+    QObject(parent),
+    context_(new QObject()),
+    backend_(createWalletBackend()),
+    idleTimer_(new QTimer()),
+    stopping_(false)
+{
+    qRegisterMetaType<WalletContentList>("WalletContentList");
+    qRegisterMetaType<WalletContentView>("WalletContentView");
+
+    context_->moveToThread(&thread_);
+
+    idleTimer_->setSingleShot(true);
+    idleTimer_->setInterval(IDLE_DELAY);
+    idleTimer_->moveToThread(&thread_);
+    connect(idleTimer_, &QTimer::timeout, context_, [this]() {
+        if (backend_ && backend_->isOpen())
+            backend_->idle();
+    });
+    connect(this, &WalletWorker::jobPosted, context_, [this]() { processQueue(); }, Qt::QueuedConnection);
+    connect(this, &WalletWorker::prepareRequested, this, &WalletWorker::prepareAndOpen, Qt::QueuedConnection);
+
+    connect(backend_, &WalletBackend::closed, this, &WalletWorker::walletClosed);
+    connect(backend_, &WalletBackend::folderUpdated, this, &WalletWorker::folderUpdated);
+
+    thread_.start();
+}
+
+WalletWorker::~WalletWorker()
+{
+    // runs after all pending requests, the backend is deleted after their commit
+    post([this]() {
+        stopping_ = true;
+        thread_.quit();
+    });
+    thread_.wait();
+
+    // never opened, the backend still belongs to this thread
+    delete backend_;
+    delete idleTimer_;
+    delete context_;
+}
+
+void WalletWorker::openWallet(QWidget* window)
+{
+    window_ = window;
+
+    // the backend is moved to the worker thread after the user was asked
+    if (backend_->thread() != &thread_)
+    {
+        prepareAndOpen();
+        return;
+    }
+
+    // a failed open is prepared again, e.g. the passphrase was wrong
+    post([this]() {
+        if (backend_->isOpen())
+            emit walletOpened(true);
+        else
+            emit prepareRequested();
+    });
+}
+
+void WalletWorker::prepareAndOpen()
+{
+    // called in the GUI thread, the worker does not use the closed backend
+    if (!window_ || !backend_->prepare(window_))
+    {
+        emit walletOpened(false);
+        return;
+    }
+
+    if (backend_->thread() != &thread_)
+        backend_->moveToThread(&thread_);
+
+    WId windowId = window_->winId();
+    post([this, windowId]() {
+        emit walletOpened(backend_->open(windowId));
+    });
+}
+
+bool WalletWorker::hidesEntryNames() const
+{
+    return backend_->hidesEntryNames();
+}
+
+QFuture<QStringList> WalletWorker::entryList()
+{
+    return run<QStringList>([this]() {
+        QStringList entries = backend_->entryList();
+        // the keys of single credentials are no entries, entry names never
+        // contain the separator, see isValidEntry()
+        entries.erase(std::remove_if(entries.begin(), entries.end(), [](const QString& key) {
+            return key.contains(KEY_SEPARATOR);
+        }), entries.end());
+        emit entryListLoaded(entries);
+        return entries;
+    });
+}
+
+QFuture<WalletContentView> WalletWorker::loadContent(const QString& entry)
+{
+    return run<WalletContentView>([this, entry]() {
+        WalletContentView content;
+        bool ok = readContent(entry, content);
+        emit contentLoaded(entry, content, ok);
+        return content;
+    });
+}
+
+QFuture<QList<WalletContentView>> WalletWorker::loadContents(const QStringList& entries)
+{
+    return run<QList<WalletContentView>>([this, entries]() {
+        QList<WalletContentView> contents;
+        contents.reserve(entries.size());
+        for (const QString& entry : entries)
+        {
+            WalletContentView content;
+            if (!readContent(entry, content))
+                break;
+            contents << content;
+        }
+        return contents;
+    });
+}
+
+QFuture<bool> WalletWorker::saveContent(const QString& entry, const WalletContentList& content)
+{
+    return runWrite(entry, [this, entry, content]() {
+        return writeContent(entry, content);
+    });
+}
+
+QFuture<bool> WalletWorker::appendContent(const QString& entry, const WalletContentList& content)
+{
+    return updateContent(entry, -1, 0, content);
+}
+
+QFuture<bool> WalletWorker::updateContent(const QString& entry, int first, int removeCount, const WalletContentList& inserted)
+{
+    return runWrite(entry, [this, entry, first, removeCount, inserted]() {
+        WalletManifest manifest;
+        bool changed;
+        return readManifest(entry, manifest, changed)
+                && replaceContent(entry, manifest, changed, first < 0 ? manifest.ids.size() : first, removeCount, inserted);
+    });
+}
+
+QFuture<bool> WalletWorker::removeEntry(const QString& entry)
+{
+    return runWrite(entry, [this, entry]() {
+        QByteArray rawData;
+        WalletManifest manifest;
+        bool split = backend_->readEntry(entry, rawData) && deserializeManifest(rawData, manifest);
+
+        // the manifest goes first, failures leave unreferenced credentials only
+        bool ok = backend_->removeEntry(entry);
+        if (ok && split)
+        {
+            for (quint32 id : manifest.ids)
+                backend_->removeEntry(credentialKey(entry, id));
+        }
+        return ok;
+    });
+}
+
+QFuture<bool> WalletWorker::renameEntry(const QString& oldName, const QString& newName)
+{
+    return runWrite(newName, [this, oldName, newName]() {
+        QByteArray rawData;
+        WalletManifest manifest;
+        bool split = backend_->readEntry(oldName, rawData) && deserializeManifest(rawData, manifest);
+
+        int renamed = 0;
+        if (split)
+        {
+            for (; renamed < manifest.ids.size(); ++renamed)
+            {
+                quint32 id = manifest.ids.at(renamed);
+                if (!backend_->renameEntry(credentialKey(oldName, id), credentialKey(newName, id)))
+                    break;
+            }
+        }
+
+        bool ok = renamed == manifest.ids.size() && backend_->renameEntry(oldName, newName);
+        if (!ok)
+        {
+            // move the credentials back to the unchanged manifest
+            while (renamed-- > 0)
+            {
+                quint32 id = manifest.ids.at(renamed);
+                backend_->renameEntry(credentialKey(newName, id), credentialKey(oldName, id));
+            }
+        }
+        return ok;
+    });
+}
+
+void WalletWorker::post(const std::function<void()>& job)
+{
+    QMutexLocker locker(&mutex_);
+
+    bool wakeUp = queue_.isEmpty();
+    queue_.enqueue(job);
+
+    if (wakeUp)
+        emit jobPosted();
+}
+
+void WalletWorker::processQueue()
+{
+    idleTimer_->stop();
+
+    forever
+    {
+        std::function<void()> job;
+        {
+            QMutexLocker locker(&mutex_);
+            if (queue_.isEmpty())
+                break;
+            job = queue_.dequeue();
+        }
+        job();
+    }
+
+    // writes of all requests processed in one go are committed together
+    const bool committed = backend_->commit();
+
+    QList<std::function<void(bool)>> completions;
+    completions.swap(completions_);
+    for (const auto& complete : completions)
+        complete(committed);
+
+    if (stopping_)
+    {
+        idleTimer_->stop();
+        if (backend_->thread() == &thread_)
+        {
+            delete backend_;
+            backend_ = nullptr;
+        }
+        return;
+    }
+
+    idleTimer_->start();
+}
+
+template<typename T>
+QFuture<T> WalletWorker::run(const std::function<T()>& job)
+{
+    QFutureInterface<T> promise;
+    promise.reportStarted();
+
+    post([promise, job]() mutable {
+        T result = job();
+        promise.reportResult(result);
+        promise.reportFinished();
+    });
+
+    return promise.future();
+}
+
+QFuture<bool> WalletWorker::runWrite(const QString& entry, const std::function<bool()>& job)
+{
+    QFutureInterface<bool> promise;
+    promise.reportStarted();
+
+    post([this, promise, entry, job]() {
+        const bool ok = job();
+
+        completions_ << [this, promise, entry, ok](bool committed) mutable {
+            emit writeFinished(entry, ok && committed);
+            promise.reportResult(ok && committed);
+            promise.reportFinished();
+        };
+    });
+
+    return promise.future();
+}
+
+bool WalletWorker::isValidEntry(const QString& entry)
+{
+    return !entry.contains(KEY_SEPARATOR);
+}
+
+bool WalletWorker::readContent(const QString& entry, WalletContentView& content)
+{
+    QByteArray rawData;
+    if (!backend_->readEntry(entry, rawData))
+        return false;
+
+    // entries written by earlier versions hold the whole list
+    if (!isManifest(rawData))
+        return content.parse(rawData);
+
+    WalletManifest manifest;
+    if (!deserializeManifest(rawData, manifest))
+        return false;
+
+    QList<WalletContentView> credentials;
+    credentials.reserve(manifest.ids.size());
+    for (quint32 id : manifest.ids)
+    {
+        WalletContentView credential;
+        if (!readCredential(entry, id, credential))
+            return false;
+        credentials << credential;
+    }
+
+    content = WalletContentView::join(credentials);
+    return true;
+}
+
+bool WalletWorker::writeContent(const QString& entry, const WalletContentList& content)
+{
+    // the stored content is replaced, only the keys of the old credentials are reused
+    WalletManifest manifest;
+    QByteArray rawData;
+    bool changed = !backend_->readEntry(entry, rawData) || !deserializeManifest(rawData, manifest);
+    if (changed)
+        manifest = WalletManifest();
+
+    return replaceContent(entry, manifest, changed, 0, manifest.ids.size(), content);
+}
+
+bool WalletWorker::replaceContent(const QString& entry, WalletManifest& manifest, bool changed,
+                                  int first, int removeCount, const WalletContentList& inserted)
+{
+    first = qBound(0, first, manifest.ids.size());
+    removeCount = qBound(0, removeCount, manifest.ids.size() - first);
+
+    // replaced credentials keep their keys, so edits leave the manifest alone
+    const int overwrite = qMin(removeCount, inserted.size());
+    for (int i = 0; i < overwrite; ++i)
+    {
+        if (!writeCredential(entry, manifest.ids.at(first + i), inserted.at(i)))
+            return false;
+    }
+
+    if (removeCount == inserted.size() && !changed)
+        return true;
+
+    QVector<quint32> ids = manifest.ids.mid(0, first + overwrite);
+    for (int i = overwrite; i < inserted.size(); ++i)
+    {
+        quint32 id = manifest.nextId++;
+        if (!writeCredential(entry, id, inserted.at(i)))
+            return false;
+        ids << id;
+    }
+    ids += manifest.ids.mid(first + removeCount);
+
+    const QVector<quint32> removed = manifest.ids.mid(first + overwrite, removeCount - overwrite);
+    manifest.ids = ids;
+
+    // the manifest goes first, failures leave unreferenced credentials only
+    if (!backend_->writeEntry(entry, serializeManifest(manifest)))
+        return false;
+
+    for (quint32 id : removed)
+        backend_->removeEntry(credentialKey(entry, id));
+    return true;
+}
+
+bool WalletWorker::readManifest(const QString& entry, WalletManifest& manifest, bool& changed)
+{
+    QByteArray rawData;
+    if (!backend_->readEntry(entry, rawData))
+        return false;
+
+    changed = false;
+    if (isManifest(rawData))
+        return deserializeManifest(rawData, manifest);
+
+    // entries written by earlier versions get one key per credential, the
+    // list is replaced when the caller writes the new manifest
+    WalletContentList content;
+    if (!deserializeContent(rawData, content))
+        return false;
+
+    manifest = WalletManifest();
+    changed = true;
+    for (const WalletContent& credential : content)
+    {
+        quint32 id = manifest.nextId++;
+        if (!writeCredential(entry, id, credential))
+            return false;
+        manifest.ids << id;
+    }
+    return true;
+}
+
+bool WalletWorker::readCredential(const QString& entry, quint32 id, WalletContentView& content)
+{
+    QByteArray rawData;
+    return backend_->readEntry(credentialKey(entry, id), rawData) && content.parse(rawData) && content.size() == 1;
+}
+
+bool WalletWorker::writeCredential(const QString& entry, quint32 id, const WalletContent& content)
+{
+    return backend_->writeEntry(credentialKey(entry, id), serializeContent(WalletContentList() << content));
+}
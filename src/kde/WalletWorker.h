@@ -0,0 +1,117 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WALLETWORKER_H
+#define WALLETWORKER_H
+
+#include "WalletContent.h"
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QQueue>
+#include <QFuture>
+#include <QPointer>
+#include <QStringList>
+#include <QTimer>
+#include <QWidget>
+#include <functional>
+
+#if defined(QT_NO_DEBUG)
+#define PASSWORD_MANAGER_FOLDER "Password Manager"
+#else
+#define PASSWORD_MANAGER_FOLDER "Password Manager (Debug)"
+#endif
+
+class WalletBackend;
+
+// Executes the wallet calls in the order they were requested on a dedicated
+// thread. Results are returned as futures and reported through signals.
+class WalletWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    WalletWorker(QObject* parent = nullptr);
+    virtual ~WalletWorker();
+
+    void openWallet(QWidget* window);
+    // see WalletBackend::hidesEntryNames(), fixed for the backend
+    bool hidesEntryNames() const;
+
+    QFuture<QStringList> entryList();
+    QFuture<WalletContentView> loadContent(const QString& entry);
+    // reads several entries in one request, stops at the first failing entry
+    QFuture<QList<WalletContentView>> loadContents(const QStringList& entries);
+    QFuture<bool> saveContent(const QString& entry, const WalletContentList& content);
+    QFuture<bool> appendContent(const QString& entry, const WalletContentList& content);
+    // replaces removeCount credentials at first by inserted, only the touched credentials are written
+    QFuture<bool> updateContent(const QString& entry, int first, int removeCount, const WalletContentList& inserted);
+    QFuture<bool> removeEntry(const QString& entry);
+    QFuture<bool> renameEntry(const QString& oldName, const QString& newName);
+
+    // false for names that would be taken for the key of a single credential
+    static bool isValidEntry(const QString& entry);
+
+signals:
+    void walletOpened(bool ok);
+    void walletClosed();
+    void folderUpdated(const QString& folder);
+    void entryListLoaded(const QStringList& entries);
+    void contentLoaded(const QString& entry, const WalletContentView& content, bool ok);
+    void writeFinished(const QString& entry, bool ok);
+
+    // internal, wakes up the worker thread
+    void jobPosted();
+    // internal, asks for the input of the user in the GUI thread
+    void prepareRequested();
+
+private:
+    QThread thread_;
+    // lives in thread_, used to execute the queued requests there
+    QObject* context_;
+    QMutex mutex_;
+    QQueue<std::function<void()>> queue_;
+    // lives in thread_ after it was prepared
+    WalletBackend* backend_;
+    // parent of the dialogs shown by the backend
+    QPointer<QWidget> window_;
+    // results of the write requests processed since the last commit, they
+    // are reported once it is known whether the commit succeeded
+    QList<std::function<void(bool)>> completions_;
+    // lives in thread_, runs the maintenance of the backend
+    QTimer* idleTimer_;
+    // set by the last request before the thread stops
+    bool stopping_;
+
+    void prepareAndOpen();
+    void post(const std::function<void()>& job);
+    void processQueue();
+
+    template<typename T>
+    QFuture<T> run(const std::function<T()>& job);
+    QFuture<bool> runWrite(const QString& entry, const std::function<bool()>& job);
+
+    bool readContent(const QString& entry, WalletContentView& content);
+    bool writeContent(const QString& entry, const WalletContentList& content);
+    bool replaceContent(const QString& entry, WalletManifest& manifest, bool changed,
+                        int first, int removeCount, const WalletContentList& inserted);
+    bool readManifest(const QString& entry, WalletManifest& manifest, bool& changed);
+    bool readCredential(const QString& entry, quint32 id, WalletContentView& content);
+    bool writeCredential(const QString& entry, quint32 id, const WalletContent& content);
+};
+
+#endif // WALLETWORKER_H
@@ -0,0 +1,518 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LocalWallet.h"
+#include "../CipherStream.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QInputDialog>
+#include <QMessageBox>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+
+#if defined(Q_OS_UNIX)
+#include <unistd.h>
+#endif
+
+namespace {
+
+const QByteArray MAGIC("PMWL");
+const quint8 VERSION = 2;
+
+// magic, version, salt and the MAC proving the passphrase
+const int HEADER_SIZE = 4 + 1 + CipherStream::SALT_LENGTH + CipherStream::MAC_LENGTH;
+
+// payload length, sequence number, nonce and MAC in front of every record
+const int RECORD_OVERHEAD = 4 + 8 + CipherStream::NONCE_LENGTH + CipherStream::MAC_LENGTH;
+
+// pending records are committed early above this size
+const int MAX_PENDING_SIZE = 1024 * 1024;
+
+// files below this size are never compacted
+const qint64 COMPACT_MIN_SIZE = 1024 * 1024;
+
+}
+
+WalletBackend* createWalletBackend()
+{
+    return new LocalWallet();
+}
+
+LocalWallet::LocalWallet() :
+    nextSequence_(0),
+    fileSize_(0),
+    liveSize_(0),
+    committedLiveSize_(0),
+    failed_(false)
+{
+    QDir dataDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+    fileName_ = dataDir.absolutePath() + QDir::separator() + "wallet.log";
+}
+
+LocalWallet::~LocalWallet()
+{
+    commit();
+}
+
+bool LocalWallet::prepare(QWidget* window)
+{
+    if (isOpen())
+        return true;
+
+    bool create = !QFile::exists(fileName_);
+    bool ok;
+
+    QString passphrase = QInputDialog::getText(
+                window,
+                tr("Local wallet"),
+                create ? tr("Choose a passphrase for the new wallet") : tr("Enter the passphrase of the wallet"),
+                QLineEdit::Password, QString(), &ok);
+    if (!ok || passphrase.isEmpty())
+        return false;
+
+    if (create)
+    {
+        QString confirmation = QInputDialog::getText(
+                    window,
+                    tr("Local wallet"), tr("Repeat the passphrase"),
+                    QLineEdit::Password, QString(), &ok);
+        if (!ok)
+            return false;
+
+        if (confirmation != passphrase)
+        {
+            QMessageBox::warning(window, tr("Local wallet"), tr("The passphrases do not match"));
+            return false;
+        }
+    }
+
+    passphrase_ = passphrase;
+    return true;
+}
+
+bool LocalWallet::open(WId window)
+{
+    if (isOpen())
+        return true;
+
+    QDir dataDir(QFileInfo(fileName_).absolutePath());
+    if (!dataDir.exists())
+        dataDir.mkpath(".");
+
+    file_.setFileName(fileName_);
+    bool exists = file_.exists() && file_.size() > 0;
+
+    bool ok = false;
+    if (file_.open(QFile::ReadWrite))
+    {
+        file_.setPermissions(QFile::ReadOwner | QFile::WriteOwner);
+        ok = exists ? load() : create();
+    }
+
+    if (!ok)
+    {
+        // asked for again by the next prepare()
+        file_.close();
+        index_.clear();
+        return false;
+    }
+
+    passphrase_.clear();
+    return true;
+}
+
+bool LocalWallet::isOpen() const
+{
+    return file_.isOpen();
+}
+
+QStringList LocalWallet::entryList()
+{
+    return index_.keys();
+}
+
+bool LocalWallet::readEntry(const QString& key, QByteArray& value)
+{
+    auto it = index_.constFind(key);
+    if (it == index_.constEnd())
+        return false;
+
+    QByteArray raw;
+    quint64 sequence;
+    Operation op;
+    QString storedKey;
+
+    // a record moved to the offset of another key decrypts fine
+    return readRecord(it.value(), raw) && decodeRecord(raw, sequence, op, storedKey, &value) && storedKey == key;
+}
+
+bool LocalWallet::writeEntry(const QString& key, const QByteArray& value)
+{
+    if (!isOpen())
+        return false;
+
+    append(Put, key, value);
+    return true;
+}
+
+bool LocalWallet::removeEntry(const QString& key)
+{
+    if (!isOpen())
+        return false;
+
+    if (index_.contains(key))
+        append(Remove, key);
+    return true;
+}
+
+bool LocalWallet::renameEntry(const QString& oldKey, const QString& newKey)
+{
+    if (!isOpen() || index_.contains(newKey))
+        return false;
+
+    QByteArray value;
+    if (!readEntry(oldKey, value))
+        return false;
+
+    append(Put, newKey, value);
+    append(Remove, oldKey);
+    return true;
+}
+
+bool LocalWallet::commit()
+{
+    // includes the records dropped by an early write of append()
+    const bool ok = writePending() && !failed_;
+    failed_ = false;
+    return ok;
+}
+
+void LocalWallet::idle()
+{
+    // compact when more than half of the records are outdated
+    if (pending_.isEmpty() && fileSize_ > COMPACT_MIN_SIZE && liveSize_ * 2 < fileSize_ - HEADER_SIZE)
+        compact();
+}
+
+bool LocalWallet::create()
+{
+    QByteArray salt = CipherStream::randomBytes(CipherStream::SALT_LENGTH);
+    CipherStream::deriveKeys(passphrase_, salt, cipherKey_, macKey_);
+
+    header_ = MAGIC;
+    header_.append(static_cast<char>(VERSION));
+    header_.append(salt);
+    header_.append(CipherStream::mac(macKey_, header_));
+
+    if (!file_.resize(0) || file_.write(header_) != HEADER_SIZE || !file_.flush())
+        return false;
+
+    nextSequence_ = 0;
+    fileSize_ = HEADER_SIZE;
+    liveSize_ = 0;
+    committedLiveSize_ = 0;
+    return true;
+}
+
+bool LocalWallet::load()
+{
+    header_ = file_.read(HEADER_SIZE);
+    if (header_.size() != HEADER_SIZE || !header_.startsWith(MAGIC) || quint8(header_.at(4)) != VERSION)
+        return false;
+
+    nextSequence_ = 0;
+
+    const QByteArray salt = header_.mid(MAGIC.size() + 1, CipherStream::SALT_LENGTH);
+    CipherStream::deriveKeys(passphrase_, salt, cipherKey_, macKey_);
+
+    // a wrong passphrase yields a different MAC
+    if (CipherStream::mac(macKey_, header_.left(HEADER_SIZE - CipherStream::MAC_LENGTH))
+            != header_.right(CipherStream::MAC_LENGTH))
+        return false;
+
+    const qint64 size = file_.size();
+    qint64 pos = HEADER_SIZE;
+
+    while (pos + RECORD_OVERHEAD <= size)
+    {
+        QByteArray raw = file_.read(sizeof(quint32));
+        Record record = { pos, RECORD_OVERHEAD + static_cast<int>(qFromBigEndian<quint32>(raw.constData())) };
+        if (pos + record.size > size)
+            break;
+
+        raw += file_.read(record.size - raw.size());
+
+        quint64 sequence;
+        Operation op;
+        QString key;
+        if (!decodeRecord(raw, sequence, op, key, nullptr))
+        {
+            qWarning() << "Wallet file is damaged at offset" << pos;
+            return false;
+        }
+
+        // records cannot be reordered or replayed from an older copy of the file
+        if (sequence < nextSequence_)
+        {
+            qWarning() << "Wallet file has a record out of order at offset" << pos;
+            return false;
+        }
+        nextSequence_ = sequence + 1;
+
+        apply(op, key, record);
+        pos += record.size;
+    }
+
+    // remains of an interrupted write
+    if (pos < size)
+        file_.resize(pos);
+
+    fileSize_ = pos;
+    committedLiveSize_ = liveSize_;
+    return true;
+}
+
+bool LocalWallet::compact()
+{
+    QSaveFile out(fileName_);
+    if (!out.open(QIODevice::WriteOnly) || out.write(header_) != header_.size())
+        return false;
+
+    QHash<QString, Record> index;
+    index.reserve(index_.size());
+    qint64 pos = header_.size();
+
+    // the records are self-contained and copied without decrypting them,
+    // in file order so the sequence numbers keep increasing
+    for (const auto& entry : sortedRecords())
+    {
+        QByteArray raw;
+        if (!readRecord(entry.second, raw) || out.write(raw) != raw.size())
+        {
+            out.cancelWriting();
+            return false;
+        }
+
+        index.insert(entry.first, Record{ pos, raw.size() });
+        pos += raw.size();
+    }
+
+    file_.close();
+    const bool ok = out.commit();
+
+    // the index belongs to the old file if it could not be replaced
+    if (!file_.open(QFile::ReadWrite))
+    {
+        qWarning() << "Could not reopen wallet file" << file_.errorString();
+        close();
+        return false;
+    }
+
+    if (ok)
+    {
+        index_.swap(index);
+        fileSize_ = pos;
+        liveSize_ = pos - header_.size();
+        committedLiveSize_ = liveSize_;
+    }
+    return ok;
+}
+
+void LocalWallet::close()
+{
+    file_.close();
+    index_.clear();
+    pending_.clear();
+    undo_.clear();
+    cipherKey_.clear();
+    macKey_.clear();
+    nextSequence_ = 0;
+    fileSize_ = 0;
+    liveSize_ = 0;
+    committedLiveSize_ = 0;
+    failed_ = false;
+
+    emit closed();
+}
+
+void LocalWallet::append(Operation op, const QString& key, const QByteArray& value)
+{
+    QByteArray raw = encodeRecord(op, key, value);
+
+    // the committed record of the key, restored if the write fails
+    if (!undo_.contains(key))
+        undo_.insert(key, index_.value(key, Record{ -1, 0 }));
+
+    Record record = { fileSize_ + pending_.size(), raw.size() };
+    pending_.append(raw);
+    apply(op, key, record);
+
+    if (pending_.size() > MAX_PENDING_SIZE && !writePending())
+        failed_ = true;
+}
+
+bool LocalWallet::writePending()
+{
+    if (pending_.isEmpty() || !isOpen())
+        return true;
+
+    file_.seek(fileSize_);
+    bool ok = file_.write(pending_) == pending_.size() && file_.flush();
+    if (!ok)
+        qWarning() << "Could not write wallet file" << file_.errorString();
+
+#if defined(Q_OS_UNIX)
+    if (ok && ::fsync(file_.handle()) != 0)
+    {
+        qWarning() << "Could not sync wallet file";
+        ok = false;
+    }
+#endif
+
+    if (!ok)
+    {
+        // drop the partial write and the records, the index must not point
+        // past the end of the file
+        file_.resize(fileSize_);
+        rollback();
+        return false;
+    }
+
+    fileSize_ += pending_.size();
+    committedLiveSize_ = liveSize_;
+    pending_.clear();
+    undo_.clear();
+    return true;
+}
+
+void LocalWallet::rollback()
+{
+    for (auto it = undo_.constBegin(); it != undo_.constEnd(); ++it)
+    {
+        if (it.value().offset < 0)
+            index_.remove(it.key());
+        else
+            index_.insert(it.key(), it.value());
+    }
+
+    liveSize_ = committedLiveSize_;
+    pending_.clear();
+    undo_.clear();
+}
+
+void LocalWallet::apply(Operation op, const QString& key, const Record& record)
+{
+    auto it = index_.find(key);
+    if (it != index_.end())
+    {
+        liveSize_ -= it.value().size;
+        index_.erase(it);
+    }
+
+    if (op == Put)
+    {
+        index_.insert(key, record);
+        liveSize_ += record.size;
+    }
+}
+
+QList<QPair<QString, LocalWallet::Record>> LocalWallet::sortedRecords() const
+{
+    QList<QPair<QString, Record>> records;
+    records.reserve(index_.size());
+    for (auto it = index_.constBegin(); it != index_.constEnd(); ++it)
+        records.append(qMakePair(it.key(), it.value()));
+
+    std::sort(records.begin(), records.end(), [](const QPair<QString, Record>& a, const QPair<QString, Record>& b) {
+        return a.second.offset < b.second.offset;
+    });
+    return records;
+}
+
+bool LocalWallet::readRecord(const Record& record, QByteArray& raw)
+{
+    if (record.offset >= fileSize_)
+    {
+        raw = pending_.mid(record.offset - fileSize_, record.size);
+    }
+    else
+    {
+        file_.seek(record.offset);
+        raw = file_.read(record.size);
+    }
+    return raw.size() == record.size;
+}
+
+QByteArray LocalWallet::encodeRecord(Operation op, const QString& key, const QByteArray& value)
+{
+    QByteArray plainText;
+    QDataStream stream(&plainText, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    stream << static_cast<quint8>(op) << key;
+    if (op == Put)
+        stream << value;
+
+    QByteArray sequence(sizeof(quint64), 0);
+    qToBigEndian<quint64>(nextSequence_++, sequence.data());
+
+    const QByteArray nonce = CipherStream::randomBytes(CipherStream::NONCE_LENGTH);
+    const QByteArray cipherText = CipherStream(cipherKey_, nonce).process(plainText);
+
+    // the MAC covers the sequence number, the key is part of the cipher text
+    QByteArray raw(sizeof(quint32), 0);
+    qToBigEndian<quint32>(cipherText.size(), raw.data());
+    raw.append(sequence);
+    raw.append(nonce);
+    raw.append(CipherStream::mac(macKey_, sequence + nonce + cipherText));
+    raw.append(cipherText);
+    return raw;
+}
+
+bool LocalWallet::decodeRecord(const QByteArray& raw, quint64& sequence, Operation& op, QString& key, QByteArray* value)
+{
+    if (raw.size() < RECORD_OVERHEAD)
+        return false;
+
+    // everything between the length and the MAC is authenticated
+    const QByteArray prefix = raw.mid(sizeof(quint32), sizeof(quint64) + CipherStream::NONCE_LENGTH);
+    const QByteArray nonce = prefix.right(CipherStream::NONCE_LENGTH);
+    const QByteArray mac = raw.mid(sizeof(quint32) + prefix.size(), CipherStream::MAC_LENGTH);
+    const QByteArray cipherText = raw.mid(RECORD_OVERHEAD);
+
+    if (CipherStream::mac(macKey_, prefix + cipherText) != mac)
+        return false;
+
+    sequence = qFromBigEndian<quint64>(prefix.constData());
+
+    const QByteArray plainText = CipherStream(cipherKey_, nonce).process(cipherText);
+    QDataStream stream(plainText);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    quint8 o;
+    stream >> o >> key;
+    op = static_cast<Operation>(o);
+
+    if (value && op == Put)
+        stream >> *value;
+
+    return stream.status() == QDataStream::Ok;
+}
@@ -0,0 +1,103 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOCALWALLET_H
+#define LOCALWALLET_H
+
+#include "../kde/WalletBackend.h"
+
+#include <QFile>
+#include <QHash>
+
+// Wallet stored in a single encrypted, append-only log file.
+//
+// Every write appends a record, the newest record of a key wins. The offsets
+// of the live records are kept in memory, so reads are a single seek. Records
+// appended while processing a batch of requests are written with one call in
+// commit(), if that fails they are dropped and the index returns to the last
+// committed state. The file is compacted when most of it is outdated and no
+// request arrived for a while. Records carry an increasing sequence number
+// covered by their MAC, so they cannot be reordered or replayed.
+class LocalWallet : public WalletBackend
+{
+    Q_OBJECT
+
+public:
+    LocalWallet();
+    virtual ~LocalWallet();
+
+    bool prepare(QWidget* window) override;
+    bool open(WId window) override;
+    bool isOpen() const override;
+    bool hidesEntryNames() const override { return true; }
+
+    QStringList entryList() override;
+    bool readEntry(const QString& key, QByteArray& value) override;
+    bool writeEntry(const QString& key, const QByteArray& value) override;
+    bool removeEntry(const QString& key) override;
+    bool renameEntry(const QString& oldKey, const QString& newKey) override;
+
+    bool commit() override;
+    void idle() override;
+
+private:
+    enum Operation
+    {
+        Put = 1,
+        Remove = 2,
+    };
+
+    struct Record
+    {
+        qint64 offset;
+        int size;
+    };
+
+    QString fileName_;
+    QString passphrase_;
+    QFile file_;
+    QByteArray header_;
+    QByteArray cipherKey_;
+    QByteArray macKey_;
+    quint64 nextSequence_;
+    QHash<QString, Record> index_;
+    // records appended after the end of the file, written by commit()
+    QByteArray pending_;
+    // committed records of the keys changed by the pending records, a
+    // negative offset if the key did not exist
+    QHash<QString, Record> undo_;
+    qint64 fileSize_;
+    qint64 liveSize_;
+    qint64 committedLiveSize_;
+    // pending records were dropped since the last commit()
+    bool failed_;
+
+    bool create();
+    bool load();
+    bool compact();
+    void close();
+    void append(Operation op, const QString& key, const QByteArray& value = QByteArray());
+    bool writePending();
+    void rollback();
+    void apply(Operation op, const QString& key, const Record& record);
+    QList<QPair<QString, Record>> sortedRecords() const;
+    bool readRecord(const Record& record, QByteArray& raw);
+    QByteArray encodeRecord(Operation op, const QString& key, const QByteArray& value);
+    bool decodeRecord(const QByteArray& raw, quint64& sequence, Operation& op, QString& key, QByteArray* value);
+};
+
+#endif // LOCALWALLET_H
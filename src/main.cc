@@ -16,6 +16,7 @@
  */
 
 #include "MainFrame.h"
+#include "BreachChecker.h"
 
 #include <QApplication>
 
@@ -34,6 +35,9 @@ int main(int argc, char** argv)
 
     QApplication app(argc, argv);
 
+    if (app.arguments().contains("--build-breach-prefilter"))
+        return BreachChecker::writePrefilter(BreachChecker::corpusFile()) ? 0 : 1;
+
     MainFrame mf;
     mainFrame = &mf;
     mf.setVisible(true);
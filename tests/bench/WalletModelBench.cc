@@ -0,0 +1,263 @@
+/*
+ * Password Manager 1.0
+ * Copyright (C) 2017 "Daniel Volk" <mail@volkarts.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "MainFrame.h"
+#include "kde/WalletModel.h"
+#include "kde/WalletWorker.h"
+#include <kwallet.h>
+
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QtTest>
+
+namespace {
+
+// a million entries take a while to be read and sorted
+const int LOAD_TIMEOUT = 10 * 60 * 1000;
+
+// number of entries written by another application at once
+const int STORM_SIZE = 100;
+
+MainFrame* mainFrame;
+
+// name of a synthetic entry of the stand-in
+QString entryName(int index)
+{
+    return QString("entry-%1").arg(index, 7, 10, QChar('0'));
+}
+
+}
+
+MainFrame* getMainFrame()
+{
+    return mainFrame;
+}
+
+class WalletModelBench : public QObject
+{
+    Q_OBJECT
+
+public:
+    WalletModelBench();
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+
+    void load_data();
+    void load();
+    void addEntry_data();
+    void addEntry();
+    void find_data();
+    void find();
+    void setData_data();
+    void setData();
+    void folderUpdated_data();
+    void folderUpdated();
+    void search_data();
+    void search();
+
+private:
+    // parent of the models, passed to the wallet as window
+    QWidget window_;
+    WalletModel* model_;
+
+    void addSizes();
+    bool openModel(int entries);
+    static bool waitForLoad(WalletModel* model);
+};
+
+WalletModelBench::WalletModelBench() :
+    model_(nullptr)
+{
+}
+
+void WalletModelBench::initTestCase()
+{
+    // the settings and files of the application are left alone
+    QCoreApplication::setOrganizationName("volkarts.com");
+    QCoreApplication::setApplicationName("Password Manager Benchmark");
+    QStandardPaths::setTestModeEnabled(true);
+
+    // shows the errors of the models, its own wallet is never opened
+    mainFrame = new MainFrame();
+}
+
+void WalletModelBench::cleanupTestCase()
+{
+    delete mainFrame;
+    mainFrame = nullptr;
+}
+
+void WalletModelBench::cleanup()
+{
+    // waits for the queued writes
+    delete model_;
+    model_ = nullptr;
+}
+
+void WalletModelBench::load_data()
+{
+    addSizes();
+}
+
+void WalletModelBench::load()
+{
+    QFETCH(int, entries);
+
+    // fills the stand-in, every run reads it with a new model
+    QVERIFY(openModel(entries));
+    delete model_;
+    model_ = nullptr;
+
+    QBENCHMARK {
+        WalletModel model(&window_);
+        QVERIFY(waitForLoad(&model));
+        QCOMPARE(model.rowCount(QModelIndex()), entries);
+    }
+}
+
+void WalletModelBench::addEntry_data()
+{
+    addSizes();
+}
+
+void WalletModelBench::addEntry()
+{
+    QFETCH(int, entries);
+    QVERIFY(openModel(entries));
+
+    int n = 0;
+    QBENCHMARK {
+        model_->addEntry(QString("added-%1").arg(n++));
+    }
+}
+
+void WalletModelBench::find_data()
+{
+    addSizes();
+}
+
+void WalletModelBench::find()
+{
+    QFETCH(int, entries);
+    QVERIFY(openModel(entries));
+
+    int n = 0;
+    QBENCHMARK {
+        QVERIFY(model_->find(entryName(n++ % entries)).isValid());
+    }
+}
+
+void WalletModelBench::setData_data()
+{
+    addSizes();
+}
+
+void WalletModelBench::setData()
+{
+    QFETCH(int, entries);
+    QVERIFY(openModel(entries));
+
+    // renamed back and forth, the row moves across half of the model
+    QString name = entryName(entries / 2);
+    QString otherName = "renamed";
+
+    QBENCHMARK {
+        QVERIFY(model_->setData(model_->find(name), otherName, Qt::EditRole));
+        name.swap(otherName);
+    }
+}
+
+void WalletModelBench::folderUpdated_data()
+{
+    addSizes();
+}
+
+void WalletModelBench::folderUpdated()
+{
+    QFETCH(int, entries);
+    QVERIFY(openModel(entries));
+
+    // another application writing to the same folder
+    QScopedPointer<KWallet::Wallet> wallet(KWallet::Wallet::openWallet(KWallet::Wallet::NetworkWallet(), 0));
+    QVERIFY(wallet->setFolder(PASSWORD_MANAGER_FOLDER));
+
+    WalletContentList content;
+    content.append(WalletContent("external", "password"));
+    const QByteArray value = serializeContent(content);
+
+    // includes the delay collecting the notifications into one reload
+    int n = 0;
+    QBENCHMARK {
+        QSignalSpy loaded(model_, &WalletModel::entriesLoaded);
+        for (int i = 0; i < STORM_SIZE; ++i)
+            wallet->writeEntry(QString("external-%1").arg(n++), value);
+        QVERIFY(loaded.wait(LOAD_TIMEOUT));
+    }
+}
+
+void WalletModelBench::search_data()
+{
+    addSizes();
+}
+
+void WalletModelBench::search()
+{
+    QFETCH(int, entries);
+    QVERIFY(openModel(entries));
+
+    // the index is built in the background, the first search waits for it
+    model_->search("entry");
+
+    // all synthetic names share their prefix, every entry is a candidate of
+    // the query, the worst case of a keystroke in the search field
+    const QString query = entryName(entries / 2);
+    QBENCHMARK {
+        QVERIFY(!model_->search(query).isEmpty());
+    }
+}
+
+void WalletModelBench::addSizes()
+{
+    QTest::addColumn<int>("entries");
+
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("10k") << 10000;
+    QTest::newRow("100k") << 100000;
+    QTest::newRow("1M") << 1000000;
+}
+
+bool WalletModelBench::openModel(int entries)
+{
+    KWallet::Wallet::setSyntheticEntries(entries);
+
+    model_ = new WalletModel(&window_);
+    return waitForLoad(model_) && model_->rowCount(QModelIndex()) == entries;
+}
+
+bool WalletModelBench::waitForLoad(WalletModel* model)
+{
+    QSignalSpy loaded(model, &WalletModel::entriesLoaded);
+    model->openWallet();
+    return loaded.wait(LOAD_TIMEOUT);
+}
+
+QTEST_MAIN(WalletModelBench)
+
+#include "WalletModelBench.moc"
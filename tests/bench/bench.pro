@@ -0,0 +1,18 @@
+# Benchmarks of the wallet model against the in-process KWallet stand-in,
+# with 1k to 1M synthetic entries. Run them without a display with
+#   ./walletbench -platform offscreen
+# single functions and sizes are selected as usual, e.g. "load:100k".
+
+TEMPLATE = app
+TARGET = walletbench
+
+QT += testlib
+
+CONFIG += testcase use_fakewallet
+
+include(../../PasswordMgr.pri)
+
+INCLUDEPATH += $$PWD/../../src
+
+SOURCES += \
+    WalletModelBench.cc